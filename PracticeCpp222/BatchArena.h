@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Monotonic arena for one batch of records. Vehicles, readers and serializers built
+// on resource() allocate by bumping a pointer and never free individually; release()
+// drops everything at once and rewinds to the start of the initial buffer, which is
+// kept for the next batch. Batches that outgrow it take more memory from upstream
+// until release(). Not thread-safe.
+class BatchArena {
+private:
+    std::unique_ptr<std::byte[]> initialBuffer;
+    std::pmr::monotonic_buffer_resource arenaResource;
+
+public:
+    explicit BatchArena(std::size_t initialBufferSize = 1024 * 1024, std::pmr::memory_resource* upstreamResource = std::pmr::get_default_resource())
+        : initialBuffer(std::make_unique_for_overwrite<std::byte[]>(initialBufferSize)),
+        arenaResource(initialBuffer.get(), initialBufferSize, upstreamResource) {
+    }
+
+    BatchArena(const BatchArena&) = delete;
+    BatchArena& operator=(const BatchArena&) = delete;
+
+    std::pmr::memory_resource* resource() {
+        return &arenaResource;
+    }
+
+    // Everything allocated from resource() must be destroyed or abandoned first.
+    void release() {
+        arenaResource.release();
+    }
+};
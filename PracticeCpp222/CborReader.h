@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "Serializer.h"
+
+// Minimal decoder for documents produced by CborSerializer: a root map whose
+// values are text, integers, floats, nested maps or arrays. It replays the
+// document into any Serializer, so CBOR can be compared with or converted to
+// JSON/XML. CBOR array elements carry no names, so they are replayed as "item".
+class CborReader {
+private:
+    static constexpr std::string_view arrayElementName = "item";
+
+    std::string_view document;
+    std::size_t readPosition = 0;
+
+    [[noreturn]] static void throwMalformed(const char* reason) {
+        throw std::runtime_error(std::string("Malformed CBOR: ") + reason);
+    }
+
+    std::uint8_t readByte() {
+        if (readPosition >= document.size()) {
+            throwMalformed("unexpected end of input");
+        }
+        return static_cast<std::uint8_t>(document[readPosition++]);
+    }
+
+    std::uint64_t readBigEndian(std::size_t byteCount) {
+        if (document.size() - readPosition < byteCount) {
+            throwMalformed("unexpected end of input");
+        }
+        std::uint64_t value = 0;
+        for (std::size_t byteIndex = 0; byteIndex < byteCount; byteIndex++) {
+            value = (value << 8) | static_cast<std::uint8_t>(document[readPosition++]);
+        }
+        return value;
+    }
+
+    std::uint64_t readArgument(std::uint8_t additionalInfo) {
+        if (additionalInfo < 24) {
+            return additionalInfo;
+        }
+        switch (additionalInfo) {
+        case 24:
+            return readBigEndian(1);
+        case 25:
+            return readBigEndian(2);
+        case 26:
+            return readBigEndian(4);
+        case 27:
+            return readBigEndian(8);
+        default:
+            throwMalformed("unsupported argument encoding");
+        }
+    }
+
+    std::string_view readText() {
+        std::uint8_t initialByte = readByte();
+        if ((initialByte >> 5) != 3) {
+            throwMalformed("expected a text string");
+        }
+        std::uint64_t textSize = readArgument(initialByte & 0x1f);
+        if (document.size() - readPosition < textSize) {
+            throwMalformed("text string exceeds input");
+        }
+        std::string_view text = document.substr(readPosition, static_cast<std::size_t>(textSize));
+        readPosition += static_cast<std::size_t>(textSize);
+        return text;
+    }
+
+    static int toIntField(std::int64_t value) {
+        if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+            throwMalformed("integer does not fit into an int field");
+        }
+        return static_cast<int>(value);
+    }
+
+    bool isContainerEnd(bool isIndefinite, std::uint64_t& remainingEntries) {
+        if (isIndefinite) {
+            if (readPosition < document.size() && static_cast<std::uint8_t>(document[readPosition]) == 0xff) {
+                readPosition++;
+                return true;
+            }
+            return false;
+        }
+        return remainingEntries-- == 0;
+    }
+
+    void replayMapEntries(Serializer& targetSerializer) {
+        std::uint8_t initialByte = readByte();
+        if ((initialByte >> 5) != 5) {
+            throwMalformed("expected a map");
+        }
+
+        bool isIndefinite = (initialByte & 0x1f) == 31;
+        std::uint64_t remainingEntries = isIndefinite ? 0 : readArgument(initialByte & 0x1f);
+        while (!isContainerEnd(isIndefinite, remainingEntries)) {
+            std::string_view entryName = readText();
+            replayValue(entryName, targetSerializer);
+        }
+    }
+
+    void replayArrayElements(Serializer& targetSerializer) {
+        std::uint8_t initialByte = readByte();
+        bool isIndefinite = (initialByte & 0x1f) == 31;
+        std::uint64_t remainingEntries = isIndefinite ? 0 : readArgument(initialByte & 0x1f);
+        while (!isContainerEnd(isIndefinite, remainingEntries)) {
+            replayValue(arrayElementName, targetSerializer);
+        }
+    }
+
+    void replayValue(std::string_view entryName, Serializer& targetSerializer) {
+        if (readPosition >= document.size()) {
+            throwMalformed("unexpected end of input");
+        }
+        std::uint8_t initialByte = static_cast<std::uint8_t>(document[readPosition]);
+        switch (initialByte >> 5) {
+        case 0:
+            readPosition++;
+            targetSerializer.addField(entryName, toIntField(static_cast<std::int64_t>(readArgument(initialByte & 0x1f))));
+            break;
+        case 1:
+            readPosition++;
+            targetSerializer.addField(entryName, toIntField(-1 - static_cast<std::int64_t>(readArgument(initialByte & 0x1f))));
+            break;
+        case 3:
+            targetSerializer.addField(entryName, readText());
+            break;
+        case 4:
+            targetSerializer.addArray(entryName);
+            replayArrayElements(targetSerializer);
+            targetSerializer.endArray();
+            break;
+        case 5:
+            targetSerializer.addBlock(entryName);
+            replayMapEntries(targetSerializer);
+            targetSerializer.endBlock();
+            break;
+        case 7:
+            readPosition++;
+            if (initialByte == 0xfb) {
+                std::uint64_t valueBits = readBigEndian(8);
+                double value;
+                std::memcpy(&value, &valueBits, sizeof(value));
+                targetSerializer.addField(entryName, value);
+            }
+            else if (initialByte == 0xfa) {
+                std::uint32_t valueBits = static_cast<std::uint32_t>(readBigEndian(4));
+                float value;
+                std::memcpy(&value, &valueBits, sizeof(value));
+                targetSerializer.addField(entryName, static_cast<double>(value));
+            }
+            else {
+                throwMalformed("unsupported simple value");
+            }
+            break;
+        default:
+            throwMalformed("unsupported major type");
+        }
+    }
+
+public:
+    explicit CborReader(std::string_view cborDocument)
+        : document(cborDocument) {
+    }
+
+    void replayInto(Serializer& targetSerializer) {
+        readPosition = 0;
+        replayMapEntries(targetSerializer);
+        if (readPosition != document.size()) {
+            throwMalformed("trailing bytes after the document");
+        }
+    }
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OutputSink.h"
+#include "OutputWriter.h"
+#include "Serializer.h"
+#include "SerializerOptions.h"
+
+// RFC 8949 output. Blocks and the document root are indefinite-length maps and
+// arrays are indefinite-length arrays, so nothing is backpatched and the writer
+// can flush to a sink at any point.
+class CborSerializer : public Serializer {
+private:
+    static constexpr char indefiniteArrayStart = static_cast<char>(0x9f);
+    static constexpr char indefiniteMapStart = static_cast<char>(0xbf);
+    static constexpr char breakStopCode = static_cast<char>(0xff);
+
+    SerializerOptions options;
+    OutputWriter output;
+    std::pmr::vector<bool> arrayScopes;
+    bool isDocumentFinished = false;
+    bool isFragment = false;
+    std::size_t fragmentBaseDepth = 0;
+
+    void appendHeaderUnchecked(unsigned int majorType, std::uint64_t argument) {
+        char initialByte = static_cast<char>(majorType << 5);
+        if (argument < 24) {
+            output.appendUnchecked(static_cast<char>(initialByte | argument));
+        }
+        else if (argument <= 0xff) {
+            output.appendUnchecked(static_cast<char>(initialByte | 24));
+            output.appendBigEndianUnchecked(argument, 1);
+        }
+        else if (argument <= 0xffff) {
+            output.appendUnchecked(static_cast<char>(initialByte | 25));
+            output.appendBigEndianUnchecked(argument, 2);
+        }
+        else if (argument <= 0xffffffff) {
+            output.appendUnchecked(static_cast<char>(initialByte | 26));
+            output.appendBigEndianUnchecked(argument, 4);
+        }
+        else {
+            output.appendUnchecked(static_cast<char>(initialByte | 27));
+            output.appendBigEndianUnchecked(argument, 8);
+        }
+    }
+
+    void appendTextUnchecked(std::string_view text) {
+        appendHeaderUnchecked(3, text.size());
+        output.appendUnchecked(text);
+    }
+
+    void appendEntryNameUnchecked(std::string_view entryName) {
+        if (arrayScopes.empty() || !arrayScopes.back()) {
+            appendTextUnchecked(entryName);
+        }
+    }
+
+    void openContainer(std::string_view containerName, bool isArray) {
+        output.reserve(getEncodedTextSize(containerName) + 1);
+        appendEntryNameUnchecked(containerName);
+        output.appendUnchecked(isArray ? indefiniteArrayStart : indefiniteMapStart);
+        arrayScopes.push_back(isArray);
+    }
+
+    void closeContainer() {
+        if (arrayScopes.size() > fragmentBaseDepth) {
+            output.append(breakStopCode);
+            arrayScopes.pop_back();
+        }
+    }
+
+    static std::size_t getEncodedTextSize(std::string_view text) {
+        return 9 + text.size();
+    }
+
+    void closeOpenBlocks() {
+        while (arrayScopes.size() > fragmentBaseDepth) {
+            closeContainer();
+        }
+    }
+
+public:
+    using Serializer::addField;
+
+    explicit CborSerializer(const SerializerOptions& serializerOptions = {})
+        : options(serializerOptions), output(options.memoryResource), arrayScopes(options.memoryResource) {
+        reset();
+    }
+
+    void addField(std::string_view fieldName, std::string_view fieldValue) override {
+        output.reserve(getEncodedTextSize(fieldName) + getEncodedTextSize(fieldValue));
+        appendEntryNameUnchecked(fieldName);
+        appendTextUnchecked(fieldValue);
+    }
+
+    void addField(std::string_view fieldName, int fieldValue) override {
+        output.reserve(getEncodedTextSize(fieldName) + 5);
+        appendEntryNameUnchecked(fieldName);
+        if (fieldValue >= 0) {
+            appendHeaderUnchecked(0, static_cast<std::uint64_t>(fieldValue));
+        }
+        else {
+            appendHeaderUnchecked(1, static_cast<std::uint64_t>(-1 - static_cast<std::int64_t>(fieldValue)));
+        }
+    }
+
+    void addField(std::string_view fieldName, double fieldValue) override {
+        std::uint64_t valueBits;
+        std::memcpy(&valueBits, &fieldValue, sizeof(valueBits));
+        output.reserve(getEncodedTextSize(fieldName) + 9);
+        appendEntryNameUnchecked(fieldName);
+        output.appendUnchecked(static_cast<char>(0xfb));
+        output.appendBigEndianUnchecked(valueBits, 8);
+    }
+
+    void addBlock(std::string_view blockName) override {
+        openContainer(blockName, false);
+    }
+
+    void endBlock() override {
+        closeContainer();
+    }
+
+    void addArray(std::string_view arrayName) override {
+        openContainer(arrayName, true);
+    }
+
+    void endArray() override {
+        closeContainer();
+    }
+
+    void reserve(std::size_t additionalSize) override {
+        output.reserveAhead(additionalSize);
+    }
+
+    std::size_t size() const override {
+        return output.size();
+    }
+
+    std::size_t nestingDepth() const override {
+        return arrayScopes.size();
+    }
+
+    void beginFragment(std::size_t fragmentDepth) override {
+        reset();
+        output.clear();
+        arrayScopes.assign(fragmentDepth, true);
+        fragmentBaseDepth = fragmentDepth;
+        isFragment = true;
+    }
+
+    void appendFragment(std::string_view fragment, std::size_t) override {
+        output.append(fragment);
+    }
+
+    std::span<char> appendFragmentSpace(std::size_t fragmentSize, std::size_t) override {
+        return std::span<char>(output.appendUninitialized(fragmentSize), fragmentSize);
+    }
+
+    void setOutputSink(OutputSink* outputSink) override {
+        output.setSink(outputSink);
+    }
+
+    bool hasOutputSink() const override {
+        return output.hasSink();
+    }
+
+    void finish() override {
+        if (!isDocumentFinished) {
+            closeOpenBlocks();
+            if (!isFragment) {
+                output.append(breakStopCode);
+            }
+            isDocumentFinished = true;
+        }
+        output.flushToSink();
+    }
+
+    std::string build() override {
+        finish();
+        return std::string(output.view());
+    }
+
+    void buildInto(std::string& targetBuffer) override {
+        finish();
+        targetBuffer.assign(output.view());
+    }
+
+    std::string_view buildView() override {
+        finish();
+        return output.view();
+    }
+
+    std::pmr::string buildAndRelease() override {
+        finish();
+        std::pmr::string releasedContent = output.release();
+        reset();
+        return releasedContent;
+    }
+
+    void reset() override {
+        output.clear();
+        output.append(indefiniteMapStart);
+        arrayScopes.clear();
+        isDocumentFinished = false;
+        isFragment = false;
+        fragmentBaseDepth = 0;
+    }
+};
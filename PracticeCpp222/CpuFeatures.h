@@ -0,0 +1,57 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PRACTICE_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define PRACTICE_X86_SIMD 0
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions marked for that target;
+// MSVC accepts the intrinsics anywhere, so the attribute expands to nothing there.
+#if PRACTICE_X86_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define PRACTICE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PRACTICE_TARGET_AVX2
+#endif
+
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+inline bool isAvx2Supported() {
+#if PRACTICE_X86_SIMD && (defined(__GNUC__) || defined(__clang__))
+    static const bool isSupported = __builtin_cpu_supports("avx2");
+    return isSupported;
+#elif PRACTICE_X86_SIMD
+    static const bool isSupported = [] {
+        int cpuInfo[4];
+        __cpuid(cpuInfo, 1);
+        bool isOsSavingYmm = (cpuInfo[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(cpuInfo, 7, 0);
+        return isOsSavingYmm && (cpuInfo[1] & (1 << 5)) != 0;
+    }();
+    return isSupported;
+#else
+    return false;
+#endif
+}
+
+// SSE2 is part of the x86-64 baseline, so only AVX2 needs a runtime check.
+inline SimdLevel detectSimdLevel() {
+    if (isAvx2Supported()) {
+        return SimdLevel::Avx2;
+    }
+    return PRACTICE_X86_SIMD ? SimdLevel::Sse2 : SimdLevel::Scalar;
+}
+
+// Clamps a requested level to what this CPU can run.
+inline SimdLevel limitSimdLevel(SimdLevel requestedLevel) {
+    SimdLevel supportedLevel = detectSimdLevel();
+    return requestedLevel < supportedLevel ? requestedLevel : supportedLevel;
+}
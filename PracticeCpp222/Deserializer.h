@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "StringInternTable.h"
+
+// Pull-based counterpart of Serializer. The caller names every block, array and
+// field in the order the serializer wrote them; the deserializer checks each name
+// against the input and fails on any mismatch. Inside an array the element names
+// are not present in every format and are ignored, just as serializers drop them.
+class Deserializer {
+private:
+    StringInternTable* internTable = nullptr;
+
+public:
+    virtual ~Deserializer() = default;
+
+    // InternedString fields are interned into this table, which must outlive the
+    // vehicles that are read. There is no default: the input is untrusted, and distinct
+    // values would grow a process-wide table for good. Pass StringInternTable::global()
+    // to share that one deliberately.
+    void setInternTable(StringInternTable& targetTable) {
+        internTable = &targetTable;
+    }
+
+    // The returned view is valid until the next call on this deserializer.
+    virtual std::string_view readText(std::string_view fieldName) = 0;
+    virtual void readField(std::string_view fieldName, int& fieldValue) = 0;
+    virtual void readField(std::string_view fieldName, double& fieldValue) = 0;
+
+    void readField(std::string_view fieldName, std::string& fieldValue) {
+        fieldValue.assign(readText(fieldName));
+    }
+
+    void readField(std::string_view fieldName, std::pmr::string& fieldValue) {
+        fieldValue.assign(readText(fieldName));
+    }
+
+    void readField(std::string_view fieldName, InternedString& fieldValue) {
+        if (internTable == nullptr) {
+            throw std::logic_error("Reading an interned field needs setInternTable() first");
+        }
+        fieldValue = InternedString(readText(fieldName), *internTable);
+    }
+
+    virtual void enterBlock(std::string_view blockName) = 0;
+    virtual void exitBlock() = 0;
+    virtual void enterArray(std::string_view arrayName) = 0;
+    virtual bool hasNextElement() = 0;
+    virtual void exitArray() = 0;
+
+    // Checks that the whole document has been consumed.
+    virtual void finish() = 0;
+};
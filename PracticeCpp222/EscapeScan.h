@@ -0,0 +1,200 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "CpuFeatures.h"
+
+// Scanning shared by the JSON and XML escapers. Clean runs are found with the widest
+// allowed instruction set and copied in bulk; only the bytes that need escaping go
+// through the traits' writeEscape(). A traits class provides:
+//   escapeTable                       256 flags, true for bytes that need escaping;
+//   hasEscapeInWord(word)             whether any of eight bytes needs escaping;
+//   escapeMaskSse2 / escapeMaskAvx2   the same test for a vector of bytes;
+//   writeEscape(character, target)    writes the replacement and returns the new end.
+
+constexpr std::uint64_t swarLowBits = 0x0101010101010101ULL;
+constexpr std::uint64_t swarHighBits = 0x8080808080808080ULL;
+
+inline std::uint64_t loadWord(const char* source) {
+    std::uint64_t word;
+    std::memcpy(&word, source, sizeof(word));
+    return word;
+}
+
+// Word-at-a-time tests: the result is non-zero if any byte matches. Bytes above the
+// first match may be flagged spuriously, so the exact position comes from a byte scan.
+inline std::uint64_t markBytesEqual(std::uint64_t word, char character) {
+    std::uint64_t difference = word ^ (swarLowBits * static_cast<unsigned char>(character));
+    return (difference - swarLowBits) & ~difference & swarHighBits;
+}
+
+inline std::uint64_t markBytesBelow(std::uint64_t word, unsigned char limit) {
+    return (word - swarLowBits * limit) & ~word & swarHighBits;
+}
+
+// Checks up to sixteen bytes with at most two word tests, loading overlapping words
+// instead of looping over the bytes.
+template<class EscapeTraits>
+bool hasEscapeInShortText(const char* source, std::size_t size) {
+    if (size >= 8) {
+        return EscapeTraits::hasEscapeInWord(loadWord(source)) || EscapeTraits::hasEscapeInWord(loadWord(source + size - 8));
+    }
+    if (size >= 4) {
+        std::uint32_t lowHalf;
+        std::uint32_t highHalf;
+        std::memcpy(&lowHalf, source, sizeof(lowHalf));
+        std::memcpy(&highHalf, source + size - 4, sizeof(highHalf));
+        return EscapeTraits::hasEscapeInWord(lowHalf | (std::uint64_t{ highHalf } << 32));
+    }
+    for (std::size_t offset = 0; offset < size; offset++) {
+        if (EscapeTraits::escapeTable[static_cast<unsigned char>(source[offset])]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Each find function returns the offset of the first byte at or after startOffset
+// that needs escaping, or text.size() if the rest is clean. The scalar one tests eight
+// bytes at a time and only walks byte by byte through a dirty word.
+template<class EscapeTraits>
+std::size_t findEscapeScalar(std::string_view text, std::size_t startOffset) {
+    std::size_t offset = startOffset;
+    for (; offset + 8 <= text.size(); offset += 8) {
+        if (EscapeTraits::hasEscapeInWord(loadWord(text.data() + offset))) {
+            break;
+        }
+    }
+    if (offset + 8 > text.size() && text.size() - startOffset >= 8 && !EscapeTraits::hasEscapeInWord(loadWord(text.data() + text.size() - 8))) {
+        return text.size();
+    }
+    for (; offset < text.size(); offset++) {
+        if (EscapeTraits::escapeTable[static_cast<unsigned char>(text[offset])]) {
+            return offset;
+        }
+    }
+    return text.size();
+}
+
+// The vector versions need at least one full register of text after startOffset and
+// finish with a load that overlaps the bytes already checked instead of a scalar tail.
+#if PRACTICE_X86_SIMD
+template<class EscapeTraits>
+unsigned findEscapeMaskSse2(const char* source) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    return static_cast<unsigned>(_mm_movemask_epi8(EscapeTraits::escapeMaskSse2(chunk)));
+}
+
+template<class EscapeTraits>
+std::size_t findEscapeSse2(std::string_view text, std::size_t startOffset) {
+    std::size_t offset = startOffset;
+    for (; offset + 16 <= text.size(); offset += 16) {
+        if (unsigned escapeMask = findEscapeMaskSse2<EscapeTraits>(text.data() + offset)) {
+            return offset + std::countr_zero(escapeMask);
+        }
+    }
+    if (offset < text.size()) {
+        offset = text.size() - 16;
+        if (unsigned escapeMask = findEscapeMaskSse2<EscapeTraits>(text.data() + offset)) {
+            return offset + std::countr_zero(escapeMask);
+        }
+    }
+    return text.size();
+}
+
+template<class EscapeTraits>
+PRACTICE_TARGET_AVX2 unsigned findEscapeMaskAvx2(const char* source) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+    return static_cast<unsigned>(_mm256_movemask_epi8(EscapeTraits::escapeMaskAvx2(chunk)));
+}
+
+template<class EscapeTraits>
+PRACTICE_TARGET_AVX2 std::size_t findEscapeAvx2(std::string_view text, std::size_t startOffset) {
+    if (text.size() - startOffset < 32) {
+        return findEscapeSse2<EscapeTraits>(text, startOffset);
+    }
+    std::size_t offset = startOffset;
+    for (; offset + 32 <= text.size(); offset += 32) {
+        if (unsigned escapeMask = findEscapeMaskAvx2<EscapeTraits>(text.data() + offset)) {
+            return offset + std::countr_zero(escapeMask);
+        }
+    }
+    if (offset < text.size()) {
+        offset = text.size() - 32;
+        if (unsigned escapeMask = findEscapeMaskAvx2<EscapeTraits>(text.data() + offset)) {
+            return offset + std::countr_zero(escapeMask);
+        }
+    }
+    return text.size();
+}
+#endif
+
+// Most names and values are shorter than a vector register; they stay on the inlined
+// scalar path and skip the dispatch.
+template<class EscapeTraits>
+std::size_t findEscape(std::string_view text, std::size_t startOffset, SimdLevel simdLevel) {
+    if (text.size() - startOffset <= 16 && !hasEscapeInShortText<EscapeTraits>(text.data() + startOffset, text.size() - startOffset)) {
+        return text.size();
+    }
+#if PRACTICE_X86_SIMD
+    if (text.size() - startOffset >= 16) {
+        if (simdLevel == SimdLevel::Avx2) {
+            return findEscapeAvx2<EscapeTraits>(text, startOffset);
+        }
+        if (simdLevel == SimdLevel::Sse2) {
+            return findEscapeSse2<EscapeTraits>(text, startOffset);
+        }
+    }
+#endif
+    return findEscapeScalar<EscapeTraits>(text, startOffset);
+}
+
+template<class EscapeTraits>
+char* encodeEscapeRuns(std::string_view text, char* target, SimdLevel simdLevel) {
+    std::size_t runBegin = 0;
+    while (true) {
+        std::size_t escapeOffset = findEscape<EscapeTraits>(text, runBegin, simdLevel);
+        if (escapeOffset > runBegin) {
+            std::memcpy(target, text.data() + runBegin, escapeOffset - runBegin);
+            target += escapeOffset - runBegin;
+        }
+        if (escapeOffset == text.size()) {
+            return target;
+        }
+        target = EscapeTraits::writeEscape(text[escapeOffset], target);
+        runBegin = escapeOffset + 1;
+    }
+}
+
+// Writes the escaped text and returns the new end. Clean texts of 4 to 16 bytes, which
+// is most names and values, are checked and copied with two overlapping word loads and
+// stores. target must have room for text.size() * EscapeTraits::maxExpansion bytes.
+template<class EscapeTraits>
+char* encodeEscapes(std::string_view text, char* target, SimdLevel simdLevel) {
+    std::size_t textSize = text.size();
+    if (textSize >= 8 && textSize <= 16) {
+        std::uint64_t headWord = loadWord(text.data());
+        std::uint64_t tailWord = loadWord(text.data() + textSize - 8);
+        if (!EscapeTraits::hasEscapeInWord(headWord) && !EscapeTraits::hasEscapeInWord(tailWord)) {
+            std::memcpy(target, &headWord, sizeof(headWord));
+            std::memcpy(target + textSize - 8, &tailWord, sizeof(tailWord));
+            return target + textSize;
+        }
+    }
+    else if (textSize >= 4 && textSize < 8) {
+        std::uint32_t headWord;
+        std::uint32_t tailWord;
+        std::memcpy(&headWord, text.data(), sizeof(headWord));
+        std::memcpy(&tailWord, text.data() + textSize - 4, sizeof(tailWord));
+        if (!EscapeTraits::hasEscapeInWord(headWord | (std::uint64_t{ tailWord } << 32))) {
+            std::memcpy(target, &headWord, sizeof(headWord));
+            std::memcpy(target + textSize - 4, &tailWord, sizeof(tailWord));
+            return target + textSize;
+        }
+    }
+    return encodeEscapeRuns<EscapeTraits>(text, target, simdLevel);
+}
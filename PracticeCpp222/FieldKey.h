@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+template<std::size_t N>
+struct StaticKey {
+    static constexpr std::size_t length = N - 1;
+
+    char text[N]{};
+
+    constexpr StaticKey(const char (&literal)[N]) {
+        for (std::size_t charIndex = 0; charIndex < N; charIndex++) {
+            text[charIndex] = literal[charIndex];
+        }
+    }
+
+    constexpr std::string_view view() const {
+        return std::string_view(text, length);
+    }
+};
+
+template<StaticKey Name>
+struct FieldKey {
+    static constexpr std::string_view name = Name.view();
+};
+
+template<StaticKey Name>
+inline constexpr FieldKey<Name> fieldKey{};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "Deserializer.h"
+#include "JsonEscapes.h"
+#include "JsonStructuralIndex.h"
+
+// Stage two of the indexed JSON reader: the same contract as JsonDeserializer, but
+// every step jumps straight to the next entry of the structural index instead of
+// scanning characters. String contents are bounded by a pair of quote entries and
+// only numbers are still read byte by byte, by std::from_chars.
+class IndexedJsonDeserializer : public Deserializer {
+private:
+    std::string_view document;
+    JsonStructuralIndex structuralIndex;
+    std::size_t nextStructural = 0;
+    bool isCommaExpected = false;
+    std::pmr::vector<bool> arrayScopes;
+    std::pmr::string decodedText;
+    SimdLevel simdLevel;
+
+    static bool isWhitespace(char character) {
+        return character == ' ' || character == '\n' || character == '\r' || character == '\t';
+    }
+
+    bool isInsideArray() const {
+        return !arrayScopes.empty() && arrayScopes.back();
+    }
+
+    char peekStructural() const {
+        if (nextStructural >= structuralIndex.size()) {
+            throwMalformedJson("unexpected end of input");
+        }
+        return document[structuralIndex[nextStructural]];
+    }
+
+    std::size_t expectStructural(char expectedCharacter, const char* reason) {
+        if (peekStructural() != expectedCharacter) {
+            throwMalformedJson(reason);
+        }
+        return structuralIndex[nextStructural++];
+    }
+
+    // Consumes an opening and a closing quote and returns what lies between them.
+    std::string_view readQuotedRaw(const char* reason) {
+        std::size_t openingQuote = expectStructural('"', reason);
+        std::size_t closingQuote = expectStructural('"', "unterminated string");
+        return document.substr(openingQuote + 1, closingQuote - openingQuote - 1);
+    }
+
+    void readMemberName(std::string_view fieldName) {
+        if (isCommaExpected) {
+            expectStructural(',', "expected ','");
+        }
+        isCommaExpected = true;
+        if (isInsideArray()) {
+            return;
+        }
+        if (readQuotedRaw("expected a field name") != fieldName) {
+            throwMalformedJson("unexpected field name");
+        }
+        expectStructural(':', "expected ':'");
+    }
+
+    template<class NumberType>
+    void readNumberValue(NumberType& fieldValue) {
+        std::size_t numberBegin = structuralIndex[nextStructural - 1] + 1;
+        while (numberBegin < document.size() && isWhitespace(document[numberBegin])) {
+            numberBegin++;
+        }
+        const char* documentEnd = document.data() + document.size();
+        auto [numberEnd, errorCode] = std::from_chars(document.data() + numberBegin, documentEnd, fieldValue);
+        if (errorCode != std::errc()) {
+            throwMalformedJson("invalid number");
+        }
+        const char* valueEnd = document.data() + (nextStructural < structuralIndex.size() ? structuralIndex[nextStructural] : document.size());
+        while (numberEnd < valueEnd && isWhitespace(*numberEnd)) {
+            numberEnd++;
+        }
+        if (numberEnd != valueEnd) {
+            throwMalformedJson("invalid number");
+        }
+    }
+
+    void openContainer(std::string_view containerName, char openingBracket, bool isArray) {
+        readMemberName(containerName);
+        expectStructural(openingBracket, isArray ? "expected '['" : "expected '{'");
+        arrayScopes.push_back(isArray);
+        isCommaExpected = false;
+    }
+
+    void closeContainer(char closingBracket) {
+        if (arrayScopes.empty()) {
+            throwMalformedJson("no open block or array");
+        }
+        expectStructural(closingBracket, closingBracket == ']' ? "expected ']'" : "expected '}'");
+        arrayScopes.pop_back();
+        isCommaExpected = true;
+    }
+
+public:
+    using Deserializer::readField;
+
+    explicit IndexedJsonDeserializer(std::string_view jsonDocument, SimdLevel maxSimdLevel = SimdLevel::Avx2, std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+        : structuralIndex(memoryResource), arrayScopes(memoryResource), decodedText(memoryResource), simdLevel(maxSimdLevel) {
+        reset(jsonDocument);
+    }
+
+    std::string_view readText(std::string_view fieldName) override {
+        readMemberName(fieldName);
+        std::string_view rawText = readQuotedRaw("expected a string");
+        if (rawText.find('\\') == std::string_view::npos) {
+            return rawText;
+        }
+        decodeJsonEscapes(rawText, decodedText);
+        return decodedText;
+    }
+
+    void readField(std::string_view fieldName, int& fieldValue) override {
+        readMemberName(fieldName);
+        readNumberValue(fieldValue);
+    }
+
+    void readField(std::string_view fieldName, double& fieldValue) override {
+        readMemberName(fieldName);
+        readNumberValue(fieldValue);
+    }
+
+    void enterBlock(std::string_view blockName) override {
+        openContainer(blockName, '{', false);
+    }
+
+    void exitBlock() override {
+        closeContainer('}');
+    }
+
+    void enterArray(std::string_view arrayName) override {
+        openContainer(arrayName, '[', true);
+    }
+
+    bool hasNextElement() override {
+        return peekStructural() != ']';
+    }
+
+    void exitArray() override {
+        closeContainer(']');
+    }
+
+    void finish() override {
+        if (!arrayScopes.empty()) {
+            throwMalformedJson("unclosed block or array");
+        }
+        std::size_t closingBrace = expectStructural('}', "expected '}'");
+        if (nextStructural != structuralIndex.size()) {
+            throwMalformedJson("trailing characters after document");
+        }
+        for (std::size_t trailingPosition = closingBrace + 1; trailingPosition < document.size(); trailingPosition++) {
+            if (!isWhitespace(document[trailingPosition])) {
+                throwMalformedJson("trailing characters after document");
+            }
+        }
+    }
+
+    // Re-indexes a new document, keeping the index storage of the previous one.
+    void reset(std::string_view jsonDocument) {
+        document = jsonDocument;
+        structuralIndex.build(document, simdLevel);
+        nextStructural = 0;
+        isCommaExpected = false;
+        arrayScopes.clear();
+        std::size_t openingBrace = expectStructural('{', "expected '{'");
+        for (std::size_t leadingPosition = 0; leadingPosition < openingBrace; leadingPosition++) {
+            if (!isWhitespace(document[leadingPosition])) {
+                throwMalformedJson("expected '{'");
+            }
+        }
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "Deserializer.h"
+#include "JsonEscapes.h"
+
+// Reads the documents JsonSerializer writes, pretty or compact, straight into the
+// caller's fields: no DOM is built, names are compared in place and strings
+// without escapes are returned as views into the input.
+class JsonDeserializer : public Deserializer {
+private:
+    std::string_view document;
+    std::size_t readPosition = 0;
+    bool isCommaExpected = false;
+    std::pmr::vector<bool> arrayScopes;
+    std::pmr::string decodedText;
+
+    static bool isWhitespace(char character) {
+        return character == ' ' || character == '\n' || character == '\r' || character == '\t';
+    }
+
+    bool isInsideArray() const {
+        return !arrayScopes.empty() && arrayScopes.back();
+    }
+
+    char peekSignificant() {
+        while (readPosition < document.size() && isWhitespace(document[readPosition])) {
+            readPosition++;
+        }
+        if (readPosition >= document.size()) {
+            throwMalformedJson("unexpected end of input");
+        }
+        return document[readPosition];
+    }
+
+    void expectCharacter(char expectedCharacter, const char* reason) {
+        if (peekSignificant() != expectedCharacter) {
+            throwMalformedJson(reason);
+        }
+        readPosition++;
+    }
+
+    void readMemberName(std::string_view fieldName) {
+        if (isCommaExpected) {
+            expectCharacter(',', "expected ','");
+        }
+        isCommaExpected = true;
+        if (isInsideArray()) {
+            return;
+        }
+        expectCharacter('"', "expected a field name");
+        if (document.size() - readPosition <= fieldName.size()
+            || document.compare(readPosition, fieldName.size(), fieldName) != 0
+            || document[readPosition + fieldName.size()] != '"') {
+            throwMalformedJson("unexpected field name");
+        }
+        readPosition += fieldName.size() + 1;
+        expectCharacter(':', "expected ':'");
+        peekSignificant();
+    }
+
+    std::string_view readStringValue() {
+        expectCharacter('"', "expected a string");
+        std::size_t textBegin = readPosition;
+        bool hasEscapes = false;
+        while (readPosition < document.size() && document[readPosition] != '"') {
+            if (document[readPosition] == '\\') {
+                hasEscapes = true;
+                readPosition++;
+            }
+            readPosition++;
+        }
+        if (readPosition >= document.size()) {
+            throwMalformedJson("unterminated string");
+        }
+        std::string_view rawText = document.substr(textBegin, readPosition++ - textBegin);
+        if (!hasEscapes) {
+            return rawText;
+        }
+        decodeJsonEscapes(rawText, decodedText);
+        return decodedText;
+    }
+
+    template<class NumberType>
+    void readNumberValue(NumberType& fieldValue) {
+        const char* numberBegin = document.data() + readPosition;
+        const char* documentEnd = document.data() + document.size();
+        auto [numberEnd, errorCode] = std::from_chars(numberBegin, documentEnd, fieldValue);
+        if (errorCode != std::errc()) {
+            throwMalformedJson("invalid number");
+        }
+        readPosition += numberEnd - numberBegin;
+    }
+
+    void openContainer(std::string_view containerName, char openingBracket, bool isArray) {
+        readMemberName(containerName);
+        expectCharacter(openingBracket, isArray ? "expected '['" : "expected '{'");
+        arrayScopes.push_back(isArray);
+        isCommaExpected = false;
+    }
+
+    void closeContainer(char closingBracket) {
+        if (arrayScopes.empty()) {
+            throwMalformedJson("no open block or array");
+        }
+        expectCharacter(closingBracket, closingBracket == ']' ? "expected ']'" : "expected '}'");
+        arrayScopes.pop_back();
+        isCommaExpected = true;
+    }
+
+public:
+    using Deserializer::readField;
+
+    explicit JsonDeserializer(std::string_view jsonDocument, std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+        : arrayScopes(memoryResource), decodedText(memoryResource) {
+        reset(jsonDocument);
+    }
+
+    std::string_view readText(std::string_view fieldName) override {
+        readMemberName(fieldName);
+        return readStringValue();
+    }
+
+    void readField(std::string_view fieldName, int& fieldValue) override {
+        readMemberName(fieldName);
+        readNumberValue(fieldValue);
+    }
+
+    void readField(std::string_view fieldName, double& fieldValue) override {
+        readMemberName(fieldName);
+        readNumberValue(fieldValue);
+    }
+
+    void enterBlock(std::string_view blockName) override {
+        openContainer(blockName, '{', false);
+    }
+
+    void exitBlock() override {
+        closeContainer('}');
+    }
+
+    void enterArray(std::string_view arrayName) override {
+        openContainer(arrayName, '[', true);
+    }
+
+    bool hasNextElement() override {
+        return peekSignificant() != ']';
+    }
+
+    void exitArray() override {
+        closeContainer(']');
+    }
+
+    void finish() override {
+        if (!arrayScopes.empty()) {
+            throwMalformedJson("unclosed block or array");
+        }
+        expectCharacter('}', "expected '}'");
+        while (readPosition < document.size() && isWhitespace(document[readPosition])) {
+            readPosition++;
+        }
+        if (readPosition != document.size()) {
+            throwMalformedJson("trailing characters after document");
+        }
+    }
+
+    std::size_t position() const {
+        return readPosition;
+    }
+
+    void reset(std::string_view jsonDocument) {
+        document = jsonDocument;
+        readPosition = 0;
+        isCommaExpected = false;
+        arrayScopes.clear();
+        expectCharacter('{', "expected '{'");
+    }
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "CpuFeatures.h"
+#include "EscapeScan.h"
+#include "Utf8.h"
+
+[[noreturn]] inline void throwMalformedJson(const char* reason) {
+    throw std::runtime_error(std::string("Malformed JSON: ") + reason);
+}
+
+inline std::uint32_t parseJsonHexQuad(std::string_view rawText, std::size_t& readPosition) {
+    if (rawText.size() - readPosition < 4) {
+        throwMalformedJson("truncated \\u escape");
+    }
+    std::uint32_t codeUnit = 0;
+    for (int digitIndex = 0; digitIndex < 4; digitIndex++) {
+        char digit = rawText[readPosition++];
+        codeUnit <<= 4;
+        if (digit >= '0' && digit <= '9') {
+            codeUnit |= digit - '0';
+        }
+        else if (digit >= 'a' && digit <= 'f') {
+            codeUnit |= digit - 'a' + 10;
+        }
+        else if (digit >= 'A' && digit <= 'F') {
+            codeUnit |= digit - 'A' + 10;
+        }
+        else {
+            throwMalformedJson("invalid \\u escape");
+        }
+    }
+    return codeUnit;
+}
+
+// Decodes the contents of a JSON string literal, without the surrounding quotes.
+inline void decodeJsonEscapes(std::string_view rawText, std::pmr::string& decodedText) {
+    decodedText.clear();
+    std::size_t readPosition = 0;
+    while (readPosition < rawText.size()) {
+        std::size_t escapePosition = rawText.find('\\', readPosition);
+        if (escapePosition == std::string_view::npos) {
+            decodedText.append(rawText.substr(readPosition));
+            return;
+        }
+        decodedText.append(rawText.substr(readPosition, escapePosition - readPosition));
+        readPosition = escapePosition + 1;
+        if (readPosition >= rawText.size()) {
+            throwMalformedJson("truncated escape sequence");
+        }
+        char escapeCode = rawText[readPosition++];
+        switch (escapeCode) {
+        case '"':
+        case '\\':
+        case '/':
+            decodedText += escapeCode;
+            break;
+        case 'b':
+            decodedText += '\b';
+            break;
+        case 'f':
+            decodedText += '\f';
+            break;
+        case 'n':
+            decodedText += '\n';
+            break;
+        case 'r':
+            decodedText += '\r';
+            break;
+        case 't':
+            decodedText += '\t';
+            break;
+        case 'u': {
+            std::uint32_t codePoint = parseJsonHexQuad(rawText, readPosition);
+            if (codePoint >= 0xd800 && codePoint < 0xdc00) {
+                if (rawText.size() - readPosition < 2 || rawText[readPosition] != '\\' || rawText[readPosition + 1] != 'u') {
+                    throwMalformedJson("unpaired surrogate");
+                }
+                readPosition += 2;
+                std::uint32_t lowSurrogate = parseJsonHexQuad(rawText, readPosition);
+                if (lowSurrogate < 0xdc00 || lowSurrogate >= 0xe000) {
+                    throwMalformedJson("unpaired surrogate");
+                }
+                codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (lowSurrogate - 0xdc00);
+            }
+            char encodedCharacter[4];
+            decodedText.append(encodedCharacter, encodeUtf8(codePoint, encodedCharacter));
+            break;
+        }
+        default:
+            throwMalformedJson("invalid escape sequence");
+        }
+    }
+}
+
+// Quotes, backslashes and control characters need an escape in a JSON string
+// literal; everything else, UTF-8 included, passes through unchanged.
+struct JsonEscapeTraits {
+    // The longest escape is \u00XX, six bytes for one input byte.
+    static constexpr std::size_t maxExpansion = 6;
+
+    static constexpr auto escapeTable = [] {
+        std::array<bool, 256> isEscaped{};
+        for (int code = 0; code < 0x20; code++) {
+            isEscaped[code] = true;
+        }
+        isEscaped['"'] = true;
+        isEscaped['\\'] = true;
+        return isEscaped;
+    }();
+
+    static bool hasEscapeInWord(std::uint64_t word) {
+        return (markBytesEqual(word, '"') | markBytesEqual(word, '\\') | markBytesBelow(word, 0x20)) != 0;
+    }
+
+#if PRACTICE_X86_SIMD
+    static __m128i escapeMaskSse2(__m128i chunk) {
+        __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8(0x1f)), chunk);
+        __m128i isQuote = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'));
+        __m128i isBackslash = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'));
+        return _mm_or_si128(_mm_or_si128(isQuote, isBackslash), isControl);
+    }
+
+    PRACTICE_TARGET_AVX2 static __m256i escapeMaskAvx2(__m256i chunk) {
+        __m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, _mm256_set1_epi8(0x1f)), chunk);
+        __m256i isQuote = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+        __m256i isBackslash = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+        return _mm256_or_si256(_mm256_or_si256(isQuote, isBackslash), isControl);
+    }
+#endif
+
+    static char* writeEscape(char character, char* target) {
+        static constexpr char hexDigits[] = "0123456789abcdef";
+
+        *target++ = '\\';
+        switch (character) {
+        case '"':
+        case '\\':
+            *target++ = character;
+            break;
+        case '\n':
+            *target++ = 'n';
+            break;
+        case '\r':
+            *target++ = 'r';
+            break;
+        case '\t':
+            *target++ = 't';
+            break;
+        case '\b':
+            *target++ = 'b';
+            break;
+        case '\f':
+            *target++ = 'f';
+            break;
+        default:
+            *target++ = 'u';
+            *target++ = '0';
+            *target++ = '0';
+            *target++ = hexDigits[static_cast<unsigned char>(character) >> 4];
+            *target++ = hexDigits[character & 0xf];
+            break;
+        }
+        return target;
+    }
+};
+
+constexpr std::size_t maxJsonEscapeExpansion = JsonEscapeTraits::maxExpansion;
+
+// Whether text can go between quotes as it is. StaticJsonBlock pastes its keys
+// verbatim and checks them with this at compile time.
+constexpr bool isJsonLiteralSafe(std::string_view text) {
+    for (char character : text) {
+        if (JsonEscapeTraits::escapeTable[static_cast<unsigned char>(character)]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes text with the escapes a JSON string literal needs and returns the new end.
+// target must have room for text.size() * maxJsonEscapeExpansion bytes.
+inline char* encodeJsonEscapes(std::string_view text, char* target, SimdLevel simdLevel) {
+    return encodeEscapes<JsonEscapeTraits>(text, target, simdLevel);
+}
+
+// Appends the escaped text to encodedText.
+inline void encodeJsonEscapes(std::string_view text, std::string& encodedText) {
+    std::size_t previousSize = encodedText.size();
+    encodedText.resize(previousSize + text.size() * maxJsonEscapeExpansion);
+    char* encodedEnd = encodeJsonEscapes(text, encodedText.data() + previousSize, limitSimdLevel(SimdLevel::Avx2));
+    encodedText.resize(encodedEnd - encodedText.data());
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "JsonEscapes.h"
+#include "NumberFormat.h"
+#include "OutputSink.h"
+#include "OutputWriter.h"
+#include "Serializer.h"
+#include "SerializerOptions.h"
+#include "StringInternTable.h"
+
+// IsPretty selects between indented output and compact output without whitespace.
+// The compact variant never computes or writes indentation; createSerializer()
+// picks the variant from SerializerOptions::pretty.
+template <bool IsPretty>
+class BasicJsonSerializer : public Serializer {
+private:
+    SerializerOptions options;
+    OutputWriter output;
+    bool isCommaNeeded = false;
+    bool isDocumentFinished = false;
+    bool isFragment = false;
+    std::size_t fragmentBaseDepth = 0;
+    std::pmr::vector<bool> arrayScopes;
+
+    std::size_t getCurrentIndentSize() const {
+        if constexpr (IsPretty) {
+            return arrayScopes.size() * 2;
+        }
+        else {
+            return 0;
+        }
+    }
+
+    bool isInsideArray() const {
+        return !arrayScopes.empty() && arrayScopes.back();
+    }
+
+    void handleCommaIfNeededUnchecked() {
+        if (isCommaNeeded) {
+            output.appendUnchecked(',');
+        }
+        if constexpr (IsPretty) {
+            output.appendUnchecked('\n');
+        }
+        isCommaNeeded = true;
+    }
+
+    void appendFieldNameUnchecked(std::string_view fieldName) {
+        handleCommaIfNeededUnchecked();
+        if constexpr (IsPretty) {
+            output.appendIndentUnchecked(getCurrentIndentSize());
+        }
+        if (!isInsideArray()) {
+            output.appendUnchecked('"');
+            appendTextUnchecked(fieldName);
+            output.appendUnchecked(IsPretty ? "\": " : "\":");
+        }
+    }
+
+    std::size_t getTextSize(std::string_view text) const {
+        return options.escapeStrings ? text.size() * maxJsonEscapeExpansion : text.size();
+    }
+
+    void appendTextUnchecked(std::string_view text) {
+        if (options.escapeStrings) {
+            output.appendJsonEscapedUnchecked(text, options.simdLevel);
+        }
+        else {
+            output.appendUnchecked(text);
+        }
+    }
+
+    void openContainer(std::string_view containerName, char openingBracket, bool isArray) {
+        output.reserve(getFieldNameSize(containerName) + 1);
+        appendFieldNameUnchecked(containerName);
+        output.appendUnchecked(openingBracket);
+        arrayScopes.push_back(isArray);
+        isCommaNeeded = false;
+    }
+
+    void closeContainer() {
+        if (arrayScopes.size() > fragmentBaseDepth) {
+            char closingBracket = arrayScopes.back() ? ']' : '}';
+            arrayScopes.pop_back();
+            output.reserve(getCurrentIndentSize() + 2);
+            if constexpr (IsPretty) {
+                output.appendUnchecked('\n');
+                output.appendIndentUnchecked(getCurrentIndentSize());
+            }
+            output.appendUnchecked(closingBracket);
+            isCommaNeeded = true;
+        }
+    }
+
+    std::size_t getFieldNameSize(std::string_view fieldName) const {
+        return 2 + getCurrentIndentSize() + getTextSize(fieldName) + 4;
+    }
+
+    void closeOpenBlocks() {
+        while (arrayScopes.size() > fragmentBaseDepth) {
+            closeContainer();
+        }
+    }
+
+public:
+    explicit BasicJsonSerializer(const SerializerOptions& serializerOptions = {})
+        : options(serializerOptions), output(options.memoryResource), arrayScopes(options.memoryResource) {
+        options.simdLevel = limitSimdLevel(options.simdLevel);
+        reset();
+    }
+
+    void addField(std::string_view fieldName, std::string_view fieldValue) override {
+        output.reserve(getFieldNameSize(fieldName) + getTextSize(fieldValue) + 2);
+        appendFieldNameUnchecked(fieldName);
+        output.appendUnchecked('"');
+        appendTextUnchecked(fieldValue);
+        output.appendUnchecked('"');
+    }
+
+    void addField(std::string_view fieldName, int fieldValue) override {
+        output.reserve(getFieldNameSize(fieldName) + maxFormattedIntegerLength);
+        appendFieldNameUnchecked(fieldName);
+        output.appendIntegerUnchecked(fieldValue);
+    }
+
+    void addField(std::string_view fieldName, double fieldValue) override {
+        output.reserve(getFieldNameSize(fieldName) + maxFormattedDoubleLength);
+        appendFieldNameUnchecked(fieldName);
+        output.appendDoubleUnchecked(fieldValue, options.doubleFormat);
+    }
+
+    void addField(std::string_view fieldName, const InternedString& fieldValue) override {
+        std::string_view escapedValue = fieldValue.interned().jsonEscapedText;
+        output.reserve(getFieldNameSize(fieldName) + escapedValue.size() + 2);
+        appendFieldNameUnchecked(fieldName);
+        output.appendUnchecked('"');
+        output.appendUnchecked(escapedValue);
+        output.appendUnchecked('"');
+    }
+
+    void addBlock(std::string_view blockName) override {
+        openContainer(blockName, '{', false);
+    }
+
+    void endBlock() override {
+        closeContainer();
+    }
+
+    void addArray(std::string_view arrayName) override {
+        openContainer(arrayName, '[', true);
+    }
+
+    void endArray() override {
+        closeContainer();
+    }
+
+    void reserve(std::size_t additionalSize) override {
+        output.reserveAhead(additionalSize);
+    }
+
+    std::size_t size() const override {
+        return output.size();
+    }
+
+    std::size_t nestingDepth() const override {
+        return arrayScopes.size();
+    }
+
+    void beginFragment(std::size_t fragmentDepth) override {
+        reset();
+        output.clear();
+        arrayScopes.assign(fragmentDepth, true);
+        fragmentBaseDepth = fragmentDepth;
+        isFragment = true;
+    }
+
+    void appendFragment(std::string_view fragment, std::size_t elementCount) override {
+        if (elementCount == 0) {
+            return;
+        }
+        if (isCommaNeeded) {
+            output.append(',');
+        }
+        output.append(fragment);
+        isCommaNeeded = true;
+    }
+
+    std::span<char> appendFragmentSpace(std::size_t fragmentSize, std::size_t elementCount) override {
+        if (elementCount == 0) {
+            return {};
+        }
+        output.reserve(1 + fragmentSize);
+        if (isCommaNeeded) {
+            output.appendUnchecked(',');
+        }
+        isCommaNeeded = true;
+        return std::span<char>(output.appendUninitialized(fragmentSize), fragmentSize);
+    }
+
+    void setOutputSink(OutputSink* outputSink) override {
+        output.setSink(outputSink);
+    }
+
+    bool hasOutputSink() const override {
+        return output.hasSink();
+    }
+
+    void finish() override {
+        if (!isDocumentFinished) {
+            closeOpenBlocks();
+            if (!isFragment) {
+                output.append(IsPretty ? "\n}" : "}");
+            }
+            isDocumentFinished = true;
+        }
+        output.flushToSink();
+    }
+
+    std::string build() override {
+        finish();
+        return std::string(output.view());
+    }
+
+    void buildInto(std::string& targetBuffer) override {
+        finish();
+        targetBuffer.assign(output.view());
+    }
+
+    std::string_view buildView() override {
+        finish();
+        return output.view();
+    }
+
+    std::pmr::string buildAndRelease() override {
+        finish();
+        std::pmr::string releasedContent = output.release();
+        reset();
+        return releasedContent;
+    }
+
+    void reset() override {
+        output.clear();
+        output.append(IsPretty ? "{\n" : "{");
+        isCommaNeeded = false;
+        isDocumentFinished = false;
+        isFragment = false;
+        fragmentBaseDepth = 0;
+        arrayScopes.clear();
+    }
+};
+
+using JsonSerializer = BasicJsonSerializer<true>;
+using CompactJsonSerializer = BasicJsonSerializer<false>;
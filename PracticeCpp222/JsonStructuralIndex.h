@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+
+#include "CpuFeatures.h"
+#include "JsonEscapes.h"
+
+// Stage one of the indexed JSON reader, after the simdjson design. The document is
+// classified 64 bytes at a time into bitmasks of quotes, backslashes and the
+// structural characters { } [ ] : , ; escaped quotes are removed, a prefix XOR over
+// the quote mask yields the in-string mask, and the positions of every structural
+// character outside strings plus every unescaped quote are written out in order.
+class JsonStructuralIndex {
+public:
+    static constexpr std::size_t blockSize = 64;
+
+private:
+    struct CharacterMasks {
+        std::uint64_t quotes;
+        std::uint64_t backslashes;
+        std::uint64_t structurals;
+    };
+
+    struct ScanState {
+        std::uint64_t isPreviousEscaped = 0;
+        std::uint64_t isInsideString = 0;
+    };
+
+    // A block adds at most blockSize positions, so the buffer is grown between blocks
+    // and written without checks inside them. It is not zero-filled first.
+    std::pmr::memory_resource* positionResource;
+    std::uint32_t* structuralPositions = nullptr;
+    std::size_t positionCapacity = 0;
+    std::size_t structuralCount = 0;
+
+    void growPositions(std::size_t writtenCount, std::size_t requiredCapacity) {
+        std::size_t newCapacity = std::max(requiredCapacity, positionCapacity * 2);
+        auto* newPositions = static_cast<std::uint32_t*>(positionResource->allocate(newCapacity * sizeof(std::uint32_t), alignof(std::uint32_t)));
+        if (writtenCount > 0) {
+            std::memcpy(newPositions, structuralPositions, writtenCount * sizeof(std::uint32_t));
+        }
+        releasePositions();
+        structuralPositions = newPositions;
+        positionCapacity = newCapacity;
+    }
+
+    void releasePositions() {
+        if (structuralPositions != nullptr) {
+            positionResource->deallocate(structuralPositions, positionCapacity * sizeof(std::uint32_t), alignof(std::uint32_t));
+        }
+    }
+
+    // Grows the buffer when fewer than blockSize positions are left after writePosition
+    // and returns the matching position in the new buffer.
+    std::uint32_t* reserveBlock(std::uint32_t* writePosition) {
+        std::size_t writtenCount = writePosition - structuralPositions;
+        if (positionCapacity - writtenCount < blockSize) {
+            growPositions(writtenCount, writtenCount + blockSize);
+        }
+        return structuralPositions + writtenCount;
+    }
+
+    std::uint32_t* getBlockLimit() const {
+        return structuralPositions + positionCapacity - blockSize;
+    }
+
+    static bool isStructuralCharacter(char character) {
+        return character == '{' || character == '}' || character == '[' || character == ']' || character == ':' || character == ',';
+    }
+
+    static CharacterMasks classifyBlockScalar(const char* block) {
+        CharacterMasks blockMasks{ 0, 0, 0 };
+        for (std::size_t byteIndex = 0; byteIndex < blockSize; byteIndex++) {
+            std::uint64_t byteBit = std::uint64_t{ 1 } << byteIndex;
+            char character = block[byteIndex];
+            if (character == '"') {
+                blockMasks.quotes |= byteBit;
+            }
+            else if (character == '\\') {
+                blockMasks.backslashes |= byteBit;
+            }
+            else if (isStructuralCharacter(character)) {
+                blockMasks.structurals |= byteBit;
+            }
+        }
+        return blockMasks;
+    }
+
+#if PRACTICE_X86_SIMD
+    static std::uint64_t matchSse2(const __m128i (&lanes)[4], char character) {
+        __m128i pattern = _mm_set1_epi8(character);
+        std::uint64_t matchMask = 0;
+        for (int laneIndex = 0; laneIndex < 4; laneIndex++) {
+            std::uint64_t laneMask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lanes[laneIndex], pattern)));
+            matchMask |= laneMask << (laneIndex * 16);
+        }
+        return matchMask;
+    }
+
+    static CharacterMasks classifyBlockSse2(const char* block) {
+        __m128i lanes[4];
+        for (int laneIndex = 0; laneIndex < 4; laneIndex++) {
+            lanes[laneIndex] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + laneIndex * 16));
+        }
+        return {
+            matchSse2(lanes, '"'),
+            matchSse2(lanes, '\\'),
+            matchSse2(lanes, '{') | matchSse2(lanes, '}') | matchSse2(lanes, '[') | matchSse2(lanes, ']') | matchSse2(lanes, ':') | matchSse2(lanes, ',')
+        };
+    }
+
+    PRACTICE_TARGET_AVX2 static std::uint64_t matchAvx2(__m256i lowLane, __m256i highLane, char character) {
+        __m256i pattern = _mm256_set1_epi8(character);
+        std::uint64_t lowMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lowLane, pattern)));
+        std::uint64_t highMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(highLane, pattern)));
+        return lowMask | (highMask << 32);
+    }
+
+    PRACTICE_TARGET_AVX2 static CharacterMasks classifyBlockAvx2(const char* block) {
+        __m256i lowLane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        __m256i highLane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+        return {
+            matchAvx2(lowLane, highLane, '"'),
+            matchAvx2(lowLane, highLane, '\\'),
+            matchAvx2(lowLane, highLane, '{') | matchAvx2(lowLane, highLane, '}') | matchAvx2(lowLane, highLane, '[')
+                | matchAvx2(lowLane, highLane, ']') | matchAvx2(lowLane, highLane, ':') | matchAvx2(lowLane, highLane, ',')
+        };
+    }
+#endif
+
+    // Marks characters preceded by an odd run of backslashes; runs may cross blocks.
+    static std::uint64_t findEscapedCharacters(std::uint64_t backslashes, ScanState& scanState) {
+        constexpr std::uint64_t evenBits = 0x5555555555555555ULL;
+        backslashes &= ~scanState.isPreviousEscaped;
+        std::uint64_t followsEscape = (backslashes << 1) | scanState.isPreviousEscaped;
+        std::uint64_t oddSequenceStarts = backslashes & ~evenBits & ~followsEscape;
+        std::uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslashes;
+        scanState.isPreviousEscaped = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0;
+        std::uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+        return (evenBits ^ invertMask) & followsEscape;
+    }
+
+    static std::uint64_t prefixXor(std::uint64_t bitmask) {
+        bitmask ^= bitmask << 1;
+        bitmask ^= bitmask << 2;
+        bitmask ^= bitmask << 4;
+        bitmask ^= bitmask << 8;
+        bitmask ^= bitmask << 16;
+        bitmask ^= bitmask << 32;
+        return bitmask;
+    }
+
+    static std::uint32_t* processBlock(const CharacterMasks& blockMasks, std::uint32_t blockOffset, ScanState& scanState, std::uint32_t* writePosition) {
+        std::uint64_t unescapedQuotes = blockMasks.quotes & ~findEscapedCharacters(blockMasks.backslashes, scanState);
+        std::uint64_t insideString = prefixXor(unescapedQuotes) ^ scanState.isInsideString;
+        scanState.isInsideString = static_cast<std::uint64_t>(static_cast<std::int64_t>(insideString) >> 63);
+
+        std::uint64_t structuralBits = (blockMasks.structurals & ~insideString) | unescapedQuotes;
+        while (structuralBits != 0) {
+            *writePosition++ = blockOffset + static_cast<std::uint32_t>(std::countr_zero(structuralBits));
+            structuralBits &= structuralBits - 1;
+        }
+        return writePosition;
+    }
+
+    template<CharacterMasks (*classifyBlock)(const char*)>
+    std::uint32_t* scanBlocks(std::string_view document, ScanState& scanState, std::uint32_t* writePosition) {
+        std::size_t fullBlockEnd = document.size() - document.size() % blockSize;
+        std::uint32_t* blockLimit = getBlockLimit();
+        for (std::size_t blockOffset = 0; blockOffset < fullBlockEnd; blockOffset += blockSize) {
+            if (writePosition > blockLimit) {
+                writePosition = reserveBlock(writePosition);
+                blockLimit = getBlockLimit();
+            }
+            writePosition = processBlock(classifyBlock(document.data() + blockOffset), static_cast<std::uint32_t>(blockOffset), scanState, writePosition);
+        }
+        return writePosition;
+    }
+
+#if PRACTICE_X86_SIMD
+    PRACTICE_TARGET_AVX2 std::uint32_t* scanBlocksAvx2(std::string_view document, ScanState& scanState, std::uint32_t* writePosition) {
+        std::size_t fullBlockEnd = document.size() - document.size() % blockSize;
+        std::uint32_t* blockLimit = getBlockLimit();
+        for (std::size_t blockOffset = 0; blockOffset < fullBlockEnd; blockOffset += blockSize) {
+            if (writePosition > blockLimit) {
+                writePosition = reserveBlock(writePosition);
+                blockLimit = getBlockLimit();
+            }
+            writePosition = processBlock(classifyBlockAvx2(document.data() + blockOffset), static_cast<std::uint32_t>(blockOffset), scanState, writePosition);
+        }
+        return writePosition;
+    }
+#endif
+
+public:
+    explicit JsonStructuralIndex(std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+        : positionResource(memoryResource) {
+    }
+
+    ~JsonStructuralIndex() {
+        releasePositions();
+    }
+
+    JsonStructuralIndex(const JsonStructuralIndex&) = delete;
+    JsonStructuralIndex& operator=(const JsonStructuralIndex&) = delete;
+
+    // Indexes the document with the widest instruction set this CPU supports, or at
+    // most with the given level. Throws if a string is left unterminated.
+    void build(std::string_view document, SimdLevel simdLevel = SimdLevel::Avx2) {
+        if (document.size() >= UINT32_MAX) {
+            throw std::length_error("JSON document is too large to index");
+        }
+        // Vehicle documents hold about one structural character per three to five
+        // bytes; denser ones grow the buffer as they are scanned.
+        std::size_t estimatedCount = document.size() / 3 + blockSize;
+        if (positionCapacity < estimatedCount) {
+            growPositions(0, estimatedCount);
+        }
+
+        ScanState scanState;
+        std::uint32_t* writePosition = structuralPositions;
+        switch (limitSimdLevel(simdLevel)) {
+#if PRACTICE_X86_SIMD
+        case SimdLevel::Avx2:
+            writePosition = scanBlocksAvx2(document, scanState, writePosition);
+            break;
+        case SimdLevel::Sse2:
+            writePosition = scanBlocks<classifyBlockSse2>(document, scanState, writePosition);
+            break;
+#endif
+        default:
+            writePosition = scanBlocks<classifyBlockScalar>(document, scanState, writePosition);
+            break;
+        }
+
+        std::size_t tailOffset = document.size() - document.size() % blockSize;
+        if (tailOffset < document.size()) {
+            char paddedBlock[blockSize];
+            std::memset(paddedBlock, ' ', blockSize);
+            std::memcpy(paddedBlock, document.data() + tailOffset, document.size() - tailOffset);
+            writePosition = reserveBlock(writePosition);
+            writePosition = processBlock(classifyBlockScalar(paddedBlock), static_cast<std::uint32_t>(tailOffset), scanState, writePosition);
+        }
+        if (scanState.isInsideString != 0) {
+            throwMalformedJson("unterminated string");
+        }
+        structuralCount = writePosition - structuralPositions;
+    }
+
+    std::size_t size() const {
+        return structuralCount;
+    }
+
+    std::uint32_t operator[](std::size_t structuralIndex) const {
+        return structuralPositions[structuralIndex];
+    }
+};
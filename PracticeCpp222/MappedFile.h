@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "OutputSink.h"
+
+// Writes into a shared mapping of the target file instead of through write() calls;
+// OutputWriter serializes straight into the mapping through reserveSpan(). The file
+// is grown by doubling whenever the mapping is full and is truncated to the number
+// of bytes actually written on close(), which the destructor also calls.
+class MappedFileSink : public OutputSink {
+private:
+    static constexpr std::size_t minimumMappingSize = 64 * 1024;
+
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+    char* mappingBegin = nullptr;
+    std::size_t mappingSize = 0;
+    std::size_t writtenSize = 0;
+
+    [[noreturn]] static void throwLastError(const char* operation) {
+#ifdef _WIN32
+        throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), operation);
+#else
+        throw std::system_error(errno, std::generic_category(), operation);
+#endif
+    }
+
+    void unmap() {
+        if (mappingBegin == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(mappingBegin);
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+#else
+        munmap(mappingBegin, mappingSize);
+#endif
+        mappingBegin = nullptr;
+    }
+
+    void mapWithSize(std::size_t newMappingSize) {
+        unmap();
+#ifdef _WIN32
+        LARGE_INTEGER fileSize;
+        fileSize.QuadPart = static_cast<LONGLONG>(newMappingSize);
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE, static_cast<DWORD>(fileSize.HighPart), fileSize.LowPart, nullptr);
+        if (mappingHandle == nullptr) {
+            throwLastError("Failed to map output file");
+        }
+        mappingBegin = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, newMappingSize));
+        if (mappingBegin == nullptr) {
+            throwLastError("Failed to map output file");
+        }
+#else
+        if (ftruncate(fileDescriptor, static_cast<off_t>(newMappingSize)) != 0) {
+            throwLastError("Failed to grow output file");
+        }
+        void* mappedAddress = mmap(nullptr, newMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+        if (mappedAddress == MAP_FAILED) {
+            throwLastError("Failed to map output file");
+        }
+        mappingBegin = static_cast<char*>(mappedAddress);
+#endif
+        mappingSize = newMappingSize;
+    }
+
+public:
+    explicit MappedFileSink(const std::string& filePath, std::size_t initialMappingSize = minimumMappingSize) {
+#ifdef _WIN32
+        fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            throwLastError("Failed to open output file");
+        }
+#else
+        fileDescriptor = open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fileDescriptor < 0) {
+            throwLastError("Failed to open output file");
+        }
+#endif
+        try {
+            mapWithSize(std::max(initialMappingSize, minimumMappingSize));
+        }
+        catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    ~MappedFileSink() override {
+        try {
+            close();
+        }
+        catch (...) {
+        }
+    }
+
+    MappedFileSink(const MappedFileSink&) = delete;
+    MappedFileSink& operator=(const MappedFileSink&) = delete;
+
+    void write(std::string_view data) override {
+        if (mappingBegin == nullptr) {
+            throw std::logic_error("Write to a closed mapped file");
+        }
+        if (mappingSize - writtenSize < data.size()) {
+            mapWithSize(std::max(mappingSize * 2, writtenSize + data.size()));
+        }
+        std::memcpy(mappingBegin + writtenSize, data.data(), data.size());
+        writtenSize += data.size();
+    }
+
+    // OutputWriter fills the mapping through these instead of a buffer of its own.
+    std::span<char> reserveSpan(std::size_t minimumSize) override {
+        if (mappingBegin == nullptr) {
+            throw std::logic_error("Write to a closed mapped file");
+        }
+        if (mappingSize - writtenSize < minimumSize) {
+            mapWithSize(std::max(mappingSize * 2, writtenSize + minimumSize));
+        }
+        return std::span<char>(mappingBegin + writtenSize, mappingSize - writtenSize);
+    }
+
+    void commit(std::size_t committedSize) override {
+        if (mappingBegin == nullptr || committedSize > mappingSize - writtenSize) {
+            throw std::logic_error("Commit beyond the reserved span of a mapped file");
+        }
+        writtenSize += committedSize;
+    }
+
+    std::size_t size() const {
+        return writtenSize;
+    }
+
+    // Unmaps the file and cuts it down to the written size. Safe to call twice.
+    void close() {
+        unmap();
+#ifdef _WIN32
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER finalSize;
+        finalSize.QuadPart = static_cast<LONGLONG>(writtenSize);
+        bool isTruncated = SetFilePointerEx(fileHandle, finalSize, nullptr, FILE_BEGIN) && SetEndOfFile(fileHandle);
+        DWORD truncateError = isTruncated ? ERROR_SUCCESS : GetLastError();
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+        if (!isTruncated) {
+            throw std::system_error(static_cast<int>(truncateError), std::system_category(), "Failed to truncate output file");
+        }
+#else
+        if (fileDescriptor < 0) {
+            return;
+        }
+        // Closing may overwrite errno, so the truncation error is saved first.
+        int truncateError = ftruncate(fileDescriptor, static_cast<off_t>(writtenSize)) == 0 ? 0 : errno;
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+        if (truncateError != 0) {
+            throw std::system_error(truncateError, std::generic_category(), "Failed to truncate output file");
+        }
+#endif
+    }
+};
+
+// Maps a whole file privately for reading. The pages are copy-on-write, so readers
+// that decode in place, such as XmlDeserializer, may modify the view without
+// touching the file. The kernel is told the file will be read sequentially.
+class MappedFileSource {
+private:
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+    char* mappingBegin = nullptr;
+    std::size_t mappingSize = 0;
+
+    [[noreturn]] static void throwLastError(const char* operation) {
+#ifdef _WIN32
+        throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), operation);
+#else
+        throw std::system_error(errno, std::generic_category(), operation);
+#endif
+    }
+
+    void release() {
+#ifdef _WIN32
+        if (mappingBegin != nullptr) {
+            UnmapViewOfFile(mappingBegin);
+        }
+        if (mappingHandle != nullptr) {
+            CloseHandle(mappingHandle);
+        }
+        if (fileHandle != INVALID_HANDLE_VALUE) {
+            CloseHandle(fileHandle);
+        }
+#else
+        if (mappingBegin != nullptr) {
+            munmap(mappingBegin, mappingSize);
+        }
+        if (fileDescriptor >= 0) {
+            ::close(fileDescriptor);
+        }
+#endif
+    }
+
+    void open(const std::string& filePath) {
+#ifdef _WIN32
+        fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            throwLastError("Failed to open input file");
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize)) {
+            throwLastError("Failed to query input file size");
+        }
+        mappingSize = static_cast<std::size_t>(fileSize.QuadPart);
+        if (mappingSize == 0) {
+            return;
+        }
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            throwLastError("Failed to map input file");
+        }
+        mappingBegin = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0));
+        if (mappingBegin == nullptr) {
+            throwLastError("Failed to map input file");
+        }
+#else
+        fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+        if (fileDescriptor < 0) {
+            throwLastError("Failed to open input file");
+        }
+        struct stat fileStatus;
+        if (fstat(fileDescriptor, &fileStatus) != 0) {
+            throwLastError("Failed to query input file size");
+        }
+        mappingSize = static_cast<std::size_t>(fileStatus.st_size);
+        if (mappingSize == 0) {
+            return;
+        }
+        void* mappedAddress = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+        if (mappedAddress == MAP_FAILED) {
+            throwLastError("Failed to map input file");
+        }
+        mappingBegin = static_cast<char*>(mappedAddress);
+        madvise(mappingBegin, mappingSize, MADV_SEQUENTIAL);
+#endif
+    }
+
+public:
+    explicit MappedFileSource(const std::string& filePath) {
+        try {
+            open(filePath);
+        }
+        catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~MappedFileSource() {
+        release();
+    }
+
+    MappedFileSource(const MappedFileSource&) = delete;
+    MappedFileSource& operator=(const MappedFileSource&) = delete;
+
+    std::string_view view() const {
+        return std::string_view(mappingBegin, mappingSize);
+    }
+
+    std::span<char> span() {
+        return std::span<char>(mappingBegin, mappingSize);
+    }
+
+    std::size_t size() const {
+        return mappingSize;
+    }
+};
@@ -0,0 +1,438 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JsonSerializer.h"
+#include "OutputSink.h"
+#include "Serializer.h"
+#include "SerializerOptions.h"
+#include "StringInternTable.h"
+
+enum class SerializerMetric : std::size_t {
+    StringFields,
+    IntegerFields,
+    DoubleFields,
+    InternedFields,
+    Blocks,
+    Arrays,
+    MaxNestingDepth,
+    BytesEmitted,
+    BufferAllocations,
+    BufferAllocatedBytes,
+    Builds,
+    BuildNanoseconds
+};
+
+constexpr std::size_t serializerMetricCount = 12;
+
+inline constexpr std::array<std::string_view, serializerMetricCount> serializerMetricNames = {
+    "stringFields", "integerFields", "doubleFields", "internedFields", "blocks", "arrays",
+    "maxNestingDepth", "bytesEmitted", "bufferAllocations", "bufferAllocatedBytes", "builds", "buildNanoseconds"
+};
+
+// The totals over all threads at the time SerializerMetricsRegistry::snapshot() was taken.
+struct SerializerMetricsSnapshot {
+    std::array<std::uint64_t, serializerMetricCount> values{};
+
+    std::uint64_t operator[](SerializerMetric metric) const {
+        return values[static_cast<std::size_t>(metric)];
+    }
+
+    // One "name: value" line per metric.
+    std::string toText() const {
+        std::string metricsText;
+        for (std::size_t metricIndex = 0; metricIndex < serializerMetricCount; metricIndex++) {
+            metricsText.append(serializerMetricNames[metricIndex]);
+            metricsText.append(": ");
+            metricsText.append(std::to_string(values[metricIndex]));
+            metricsText += '\n';
+        }
+        return metricsText;
+    }
+
+    // A flat JSON object keyed by metric name. Serializer fields hold an int or a
+    // double, so the counts are written as doubles, exact below 2^53.
+    std::string toJson() const {
+        CompactJsonSerializer metricsSerializer;
+        for (std::size_t metricIndex = 0; metricIndex < serializerMetricCount; metricIndex++) {
+            metricsSerializer.addField(serializerMetricNames[metricIndex], static_cast<double>(values[metricIndex]));
+        }
+        return metricsSerializer.build();
+    }
+};
+
+// Every thread records into its own block of counters, which no other thread writes,
+// so recording is a relaxed load and store without a locked instruction. snapshot()
+// sums the live blocks under the registry lock; a thread's counts are folded into the
+// retired totals when it exits. MaxNestingDepth is combined by maximum, the other
+// metrics by sum.
+class SerializerMetricsRegistry {
+private:
+    using CounterBlock = std::array<std::atomic<std::uint64_t>, serializerMetricCount>;
+
+    struct ThreadCounters {
+        CounterBlock counters{};
+
+        ThreadCounters() {
+            global().attach(counters);
+        }
+
+        ~ThreadCounters() {
+            global().detach(counters);
+        }
+    };
+
+    mutable std::mutex registryMutex;
+    std::vector<CounterBlock*> liveCounters;
+    std::array<std::uint64_t, serializerMetricCount> retiredValues{};
+
+    static void accumulate(std::array<std::uint64_t, serializerMetricCount>& totals, const CounterBlock& counters) {
+        for (std::size_t metricIndex = 0; metricIndex < serializerMetricCount; metricIndex++) {
+            std::uint64_t value = counters[metricIndex].load(std::memory_order_relaxed);
+            if (metricIndex == static_cast<std::size_t>(SerializerMetric::MaxNestingDepth)) {
+                totals[metricIndex] = std::max(totals[metricIndex], value);
+            }
+            else {
+                totals[metricIndex] += value;
+            }
+        }
+    }
+
+    void attach(CounterBlock& counters) {
+        std::lock_guard registryLock(registryMutex);
+        liveCounters.push_back(&counters);
+    }
+
+    void detach(const CounterBlock& counters) {
+        std::lock_guard registryLock(registryMutex);
+        accumulate(retiredValues, counters);
+        liveCounters.erase(std::find(liveCounters.begin(), liveCounters.end(), &counters));
+    }
+
+    static CounterBlock& getThreadCounters() {
+        thread_local ThreadCounters currentThreadCounters;
+        return currentThreadCounters.counters;
+    }
+
+    SerializerMetricsRegistry() = default;
+
+public:
+    SerializerMetricsRegistry(const SerializerMetricsRegistry&) = delete;
+    SerializerMetricsRegistry& operator=(const SerializerMetricsRegistry&) = delete;
+
+    static SerializerMetricsRegistry& global() {
+        static SerializerMetricsRegistry globalRegistry;
+        return globalRegistry;
+    }
+
+    void add(SerializerMetric metric, std::uint64_t amount) {
+        std::atomic<std::uint64_t>& counter = getThreadCounters()[static_cast<std::size_t>(metric)];
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    // Adds counts collected elsewhere to the calling thread's counters in one pass.
+    void merge(const std::array<std::uint64_t, serializerMetricCount>& counts) {
+        CounterBlock& counters = getThreadCounters();
+        for (std::size_t metricIndex = 0; metricIndex < serializerMetricCount; metricIndex++) {
+            std::uint64_t value = counters[metricIndex].load(std::memory_order_relaxed);
+            if (metricIndex == static_cast<std::size_t>(SerializerMetric::MaxNestingDepth)) {
+                value = std::max(value, counts[metricIndex]);
+            }
+            else {
+                value += counts[metricIndex];
+            }
+            counters[metricIndex].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    SerializerMetricsSnapshot snapshot() const {
+        SerializerMetricsSnapshot metricsSnapshot;
+        std::lock_guard registryLock(registryMutex);
+        metricsSnapshot.values = retiredValues;
+        for (const CounterBlock* counters : liveCounters) {
+            accumulate(metricsSnapshot.values, *counters);
+        }
+        return metricsSnapshot;
+    }
+
+    // Counts that other threads record while this runs may survive the reset.
+    void reset() {
+        std::lock_guard registryLock(registryMutex);
+        retiredValues.fill(0);
+        for (CounterBlock* counters : liveCounters) {
+            for (std::atomic<std::uint64_t>& counter : *counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Forwards to the upstream resource and counts what the wrapped serializer allocates:
+// once its buffers are warm, that is one allocation per growth of the output buffer
+// or of the bookkeeping containers.
+class CountingMemoryResource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstreamResource;
+
+    void* do_allocate(std::size_t byteCount, std::size_t alignment) override {
+        SerializerMetricsRegistry& metricsRegistry = SerializerMetricsRegistry::global();
+        metricsRegistry.add(SerializerMetric::BufferAllocations, 1);
+        metricsRegistry.add(SerializerMetric::BufferAllocatedBytes, byteCount);
+        return upstreamResource->allocate(byteCount, alignment);
+    }
+
+    void do_deallocate(void* allocatedMemory, std::size_t byteCount, std::size_t alignment) override {
+        upstreamResource->deallocate(allocatedMemory, byteCount, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& otherResource) const noexcept override {
+        return this == &otherResource;
+    }
+
+public:
+    explicit CountingMemoryResource(std::pmr::memory_resource* upstream)
+        : upstreamResource(upstream) {
+    }
+
+    std::pmr::memory_resource* upstream() const {
+        return upstreamResource;
+    }
+};
+
+class CountingOutputSink : public OutputSink {
+private:
+    OutputSink* targetSink = nullptr;
+
+public:
+    void setTarget(OutputSink* outputSink) {
+        targetSink = outputSink;
+    }
+
+    void write(std::string_view data) override {
+        SerializerMetricsRegistry::global().add(SerializerMetric::BytesEmitted, data.size());
+        targetSink->write(data);
+    }
+
+    std::span<char> reserveSpan(std::size_t minimumSize) override {
+        return targetSink->reserveSpan(minimumSize);
+    }
+
+    void commit(std::size_t committedSize) override {
+        SerializerMetricsRegistry::global().add(SerializerMetric::BytesEmitted, committedSize);
+        targetSink->commit(committedSize);
+    }
+};
+
+// Records what passes through the wrapped serializer in the global registry: fields
+// by value type, blocks, arrays and the deepest nesting, the bytes of each built
+// document or sink write, the wrapped serializer's allocations, and the wall time
+// from the first call after reset() to the end of the build. Bytes are counted per
+// serializer, so the fragments of a ParallelBatchSerializer count once in their
+// worker and again in the document. createSerializer() returns one when
+// SerializerOptions::collectMetrics is set.
+class MetricsSerializer : public Serializer {
+private:
+    CountingMemoryResource countingResource;
+    std::unique_ptr<Serializer> innerSerializer;
+    CountingOutputSink countingSink;
+    bool isSinkAttached = false;
+    bool isDocumentStarted = false;
+    bool isBuildRecorded = false;
+    std::chrono::steady_clock::time_point documentStartTime;
+    std::array<std::uint64_t, serializerMetricCount> pendingCounts{};
+
+    SerializerOptions getInnerOptions(const SerializerOptions& serializerOptions) {
+        SerializerOptions innerOptions = serializerOptions;
+        innerOptions.collectMetrics = false;
+        innerOptions.memoryResource = &countingResource;
+        return innerOptions;
+    }
+
+    void record(SerializerMetric metric) {
+        if (!isDocumentStarted) {
+            isDocumentStarted = true;
+            documentStartTime = std::chrono::steady_clock::now();
+        }
+        pendingCounts[static_cast<std::size_t>(metric)]++;
+    }
+
+    void recordNestingDepth() {
+        std::uint64_t& maxNestingDepth = pendingCounts[static_cast<std::size_t>(SerializerMetric::MaxNestingDepth)];
+        maxNestingDepth = std::max<std::uint64_t>(maxNestingDepth, innerSerializer->nestingDepth());
+    }
+
+    // Counts are kept in the serializer while a document is written and handed to the
+    // registry once per document, so a field costs an increment rather than a
+    // thread-local lookup.
+    void flushPendingCounts() {
+        SerializerMetricsRegistry::global().merge(pendingCounts);
+        pendingCounts.fill(0);
+    }
+
+    // A document counts once however many times it is finished or built; reset() and
+    // buildAndRelease() start the next one.
+    void recordBuild(std::size_t documentSize) {
+        if (isBuildRecorded) {
+            return;
+        }
+        isBuildRecorded = true;
+        pendingCounts[static_cast<std::size_t>(SerializerMetric::Builds)]++;
+        if (!isSinkAttached) {
+            pendingCounts[static_cast<std::size_t>(SerializerMetric::BytesEmitted)] += documentSize;
+        }
+        if (isDocumentStarted) {
+            auto buildDuration = std::chrono::steady_clock::now() - documentStartTime;
+            pendingCounts[static_cast<std::size_t>(SerializerMetric::BuildNanoseconds)] += std::chrono::duration_cast<std::chrono::nanoseconds>(buildDuration).count();
+            isDocumentStarted = false;
+        }
+        flushPendingCounts();
+    }
+
+public:
+    // makeInnerSerializer receives serializerOptions with the memory resource replaced
+    // by the counting one and returns the serializer to wrap.
+    template<class SerializerMaker>
+    MetricsSerializer(const SerializerOptions& serializerOptions, SerializerMaker makeInnerSerializer)
+        : countingResource(serializerOptions.memoryResource),
+          innerSerializer(makeInnerSerializer(getInnerOptions(serializerOptions))) {
+    }
+
+    MetricsSerializer(const MetricsSerializer&) = delete;
+    MetricsSerializer& operator=(const MetricsSerializer&) = delete;
+
+    ~MetricsSerializer() override {
+        flushPendingCounts();
+    }
+
+    void addField(std::string_view fieldName, std::string_view fieldValue) override {
+        record(SerializerMetric::StringFields);
+        innerSerializer->addField(fieldName, fieldValue);
+    }
+
+    void addField(std::string_view fieldName, int fieldValue) override {
+        record(SerializerMetric::IntegerFields);
+        innerSerializer->addField(fieldName, fieldValue);
+    }
+
+    void addField(std::string_view fieldName, double fieldValue) override {
+        record(SerializerMetric::DoubleFields);
+        innerSerializer->addField(fieldName, fieldValue);
+    }
+
+    void addField(std::string_view fieldName, const InternedString& fieldValue) override {
+        record(SerializerMetric::InternedFields);
+        innerSerializer->addField(fieldName, fieldValue);
+    }
+
+    void addBlock(std::string_view blockName) override {
+        record(SerializerMetric::Blocks);
+        innerSerializer->addBlock(blockName);
+        recordNestingDepth();
+    }
+
+    void endBlock() override {
+        innerSerializer->endBlock();
+    }
+
+    void addArray(std::string_view arrayName) override {
+        record(SerializerMetric::Arrays);
+        innerSerializer->addArray(arrayName);
+        recordNestingDepth();
+    }
+
+    void endArray() override {
+        innerSerializer->endArray();
+    }
+
+    void reserve(std::size_t additionalSize) override {
+        innerSerializer->reserve(additionalSize);
+    }
+
+    std::size_t size() const override {
+        return innerSerializer->size();
+    }
+
+    std::size_t nestingDepth() const override {
+        return innerSerializer->nestingDepth();
+    }
+
+    void beginFragment(std::size_t fragmentDepth) override {
+        innerSerializer->beginFragment(fragmentDepth);
+        isDocumentStarted = false;
+        isBuildRecorded = false;
+    }
+
+    void appendFragment(std::string_view fragment, std::size_t elementCount) override {
+        innerSerializer->appendFragment(fragment, elementCount);
+    }
+
+    std::span<char> appendFragmentSpace(std::size_t fragmentSize, std::size_t elementCount) override {
+        return innerSerializer->appendFragmentSpace(fragmentSize, elementCount);
+    }
+
+    void setOutputSink(OutputSink* outputSink) override {
+        isSinkAttached = outputSink != nullptr;
+        countingSink.setTarget(outputSink);
+        innerSerializer->setOutputSink(isSinkAttached ? &countingSink : nullptr);
+    }
+
+    bool hasOutputSink() const override {
+        return isSinkAttached;
+    }
+
+    // With a sink attached the document ends here rather than in a build call.
+    void finish() override {
+        innerSerializer->finish();
+        if (isSinkAttached) {
+            recordBuild(0);
+        }
+    }
+
+    std::string build() override {
+        std::string builtDocument = innerSerializer->build();
+        recordBuild(builtDocument.size());
+        return builtDocument;
+    }
+
+    void buildInto(std::string& targetBuffer) override {
+        innerSerializer->buildInto(targetBuffer);
+        recordBuild(targetBuffer.size());
+    }
+
+    std::string_view buildView() override {
+        std::string_view builtDocument = innerSerializer->buildView();
+        recordBuild(builtDocument.size());
+        return builtDocument;
+    }
+
+    // The counting resource lives only as long as this serializer, so the document is
+    // copied into a string on the caller's resource; the wrapped serializer keeps its
+    // buffer for the next document.
+    std::pmr::string buildAndRelease() override {
+        std::string_view builtDocument = innerSerializer->buildView();
+        std::pmr::string releasedContent(builtDocument, countingResource.upstream());
+        recordBuild(releasedContent.size());
+        innerSerializer->reset();
+        isBuildRecorded = false;
+        return releasedContent;
+    }
+
+    void reset() override {
+        innerSerializer->reset();
+        isDocumentStarted = false;
+        isBuildRecorded = false;
+        flushPendingCounts();
+    }
+};
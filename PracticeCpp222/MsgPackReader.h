@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "Serializer.h"
+
+// Minimal decoder for documents produced by MsgPackSerializer: a root map whose
+// values are strings, integers, floats, nested maps or arrays. Every map and array
+// header count and every string length is checked against the input, so replaying a
+// document into a JsonSerializer verifies the backpatched container headers.
+// MessagePack array elements carry no names, so they are replayed as "item".
+class MsgPackReader {
+private:
+    static constexpr std::string_view arrayElementName = "item";
+
+    std::string_view document;
+    std::size_t readPosition = 0;
+
+    [[noreturn]] static void throwMalformed(const char* reason) {
+        throw std::runtime_error(std::string("Malformed MessagePack: ") + reason);
+    }
+
+    std::uint8_t readByte() {
+        if (readPosition >= document.size()) {
+            throwMalformed("unexpected end of input");
+        }
+        return static_cast<std::uint8_t>(document[readPosition++]);
+    }
+
+    std::uint64_t readBigEndian(std::size_t byteCount) {
+        if (document.size() - readPosition < byteCount) {
+            throwMalformed("unexpected end of input");
+        }
+        std::uint64_t value = 0;
+        for (std::size_t byteIndex = 0; byteIndex < byteCount; byteIndex++) {
+            value = (value << 8) | static_cast<std::uint8_t>(document[readPosition++]);
+        }
+        return value;
+    }
+
+    // Returns the string length for a str header byte, or false if it is not one.
+    bool readStringSize(std::uint8_t headerByte, std::uint64_t& textSize) {
+        if ((headerByte & 0xe0) == 0xa0) {
+            textSize = headerByte & 0x1f;
+            return true;
+        }
+        switch (headerByte) {
+        case 0xd9:
+            textSize = readBigEndian(1);
+            return true;
+        case 0xda:
+            textSize = readBigEndian(2);
+            return true;
+        case 0xdb:
+            textSize = readBigEndian(4);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    std::string_view readTextBody(std::uint64_t textSize) {
+        if (document.size() - readPosition < textSize) {
+            throwMalformed("string exceeds input");
+        }
+        std::string_view text = document.substr(readPosition, static_cast<std::size_t>(textSize));
+        readPosition += static_cast<std::size_t>(textSize);
+        return text;
+    }
+
+    std::string_view readText() {
+        std::uint64_t textSize;
+        if (!readStringSize(readByte(), textSize)) {
+            throwMalformed("expected a string");
+        }
+        return readTextBody(textSize);
+    }
+
+    static int toIntField(std::int64_t value) {
+        if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+            throwMalformed("integer does not fit into an int field");
+        }
+        return static_cast<int>(value);
+    }
+
+    // Every entry takes at least one byte, so a count beyond the remaining input is
+    // rejected before the loop instead of running off the end entry by entry.
+    void checkEntryCount(std::uint64_t entryCount) const {
+        if (entryCount > document.size() - readPosition) {
+            throwMalformed("container count exceeds input");
+        }
+    }
+
+    void replayMapEntries(std::uint64_t entryCount, Serializer& targetSerializer) {
+        checkEntryCount(entryCount);
+        for (std::uint64_t entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+            std::string_view entryName = readText();
+            replayValue(entryName, targetSerializer);
+        }
+    }
+
+    void replayArrayElements(std::uint64_t elementCount, Serializer& targetSerializer) {
+        checkEntryCount(elementCount);
+        for (std::uint64_t elementIndex = 0; elementIndex < elementCount; elementIndex++) {
+            replayValue(arrayElementName, targetSerializer);
+        }
+    }
+
+    bool readMapSize(std::uint8_t headerByte, std::uint64_t& entryCount) {
+        if ((headerByte & 0xf0) == 0x80) {
+            entryCount = headerByte & 0x0f;
+            return true;
+        }
+        if (headerByte == 0xde || headerByte == 0xdf) {
+            entryCount = readBigEndian(headerByte == 0xde ? 2 : 4);
+            return true;
+        }
+        return false;
+    }
+
+    bool readArraySize(std::uint8_t headerByte, std::uint64_t& elementCount) {
+        if ((headerByte & 0xf0) == 0x90) {
+            elementCount = headerByte & 0x0f;
+            return true;
+        }
+        if (headerByte == 0xdc || headerByte == 0xdd) {
+            elementCount = readBigEndian(headerByte == 0xdc ? 2 : 4);
+            return true;
+        }
+        return false;
+    }
+
+    void replayValue(std::string_view entryName, Serializer& targetSerializer) {
+        std::uint8_t headerByte = readByte();
+        std::uint64_t entrySize;
+        if (headerByte <= 0x7f) {
+            targetSerializer.addField(entryName, static_cast<int>(headerByte));
+        }
+        else if (headerByte >= 0xe0) {
+            targetSerializer.addField(entryName, static_cast<int>(static_cast<std::int8_t>(headerByte)));
+        }
+        else if (readStringSize(headerByte, entrySize)) {
+            targetSerializer.addField(entryName, readTextBody(entrySize));
+        }
+        else if (readMapSize(headerByte, entrySize)) {
+            targetSerializer.addBlock(entryName);
+            replayMapEntries(entrySize, targetSerializer);
+            targetSerializer.endBlock();
+        }
+        else if (readArraySize(headerByte, entrySize)) {
+            targetSerializer.addArray(entryName);
+            replayArrayElements(entrySize, targetSerializer);
+            targetSerializer.endArray();
+        }
+        else {
+            switch (headerByte) {
+            case 0xcc:
+                targetSerializer.addField(entryName, toIntField(static_cast<std::int64_t>(readBigEndian(1))));
+                break;
+            case 0xcd:
+                targetSerializer.addField(entryName, toIntField(static_cast<std::int64_t>(readBigEndian(2))));
+                break;
+            case 0xce:
+                targetSerializer.addField(entryName, toIntField(static_cast<std::int64_t>(readBigEndian(4))));
+                break;
+            case 0xd0:
+                targetSerializer.addField(entryName, static_cast<int>(static_cast<std::int8_t>(readBigEndian(1))));
+                break;
+            case 0xd1:
+                targetSerializer.addField(entryName, static_cast<int>(static_cast<std::int16_t>(readBigEndian(2))));
+                break;
+            case 0xd2:
+                targetSerializer.addField(entryName, static_cast<int>(static_cast<std::int32_t>(readBigEndian(4))));
+                break;
+            case 0xca: {
+                std::uint32_t valueBits = static_cast<std::uint32_t>(readBigEndian(4));
+                float value;
+                std::memcpy(&value, &valueBits, sizeof(value));
+                targetSerializer.addField(entryName, static_cast<double>(value));
+                break;
+            }
+            case 0xcb: {
+                std::uint64_t valueBits = readBigEndian(8);
+                double value;
+                std::memcpy(&value, &valueBits, sizeof(value));
+                targetSerializer.addField(entryName, value);
+                break;
+            }
+            default:
+                throwMalformed("unsupported type");
+            }
+        }
+    }
+
+public:
+    explicit MsgPackReader(std::string_view msgPackDocument)
+        : document(msgPackDocument) {
+    }
+
+    void replayInto(Serializer& targetSerializer) {
+        readPosition = 0;
+        std::uint64_t entryCount;
+        if (!readMapSize(readByte(), entryCount)) {
+            throwMalformed("expected a map");
+        }
+        replayMapEntries(entryCount, targetSerializer);
+        if (readPosition != document.size()) {
+            throwMalformed("trailing bytes after the document");
+        }
+    }
+};
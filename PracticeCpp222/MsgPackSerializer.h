@@ -0,0 +1,275 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OutputSink.h"
+#include "OutputWriter.h"
+#include "Serializer.h"
+#include "SerializerOptions.h"
+
+// Blocks become MessagePack maps and arrays become arrays. Their sizes are only
+// known when they are closed, so each gets a 16-bit placeholder header that is
+// rewritten to the smallest encoding on close. The document stays in memory until
+// finish() because of that backpatching.
+class MsgPackSerializer : public Serializer {
+private:
+    struct OpenContainer {
+        std::size_t headerOffset;
+        std::uint32_t entryCount;
+        bool isArray;
+    };
+
+    static constexpr std::size_t containerPlaceholderSize = 3;
+
+    SerializerOptions options;
+    OutputWriter output;
+    std::pmr::vector<OpenContainer> containerStack;
+    OutputSink* outputSink = nullptr;
+    bool isDocumentFinished = false;
+    bool isFragment = false;
+
+    void openContainer(bool isArray) {
+        containerStack.push_back({ output.size(), 0, isArray });
+        output.reserve(containerPlaceholderSize);
+        output.appendUnchecked(static_cast<char>(isArray ? 0xdc : 0xde));
+        output.appendBigEndianUnchecked(0, 2);
+    }
+
+    void closeContainer() {
+        OpenContainer closedContainer = containerStack.back();
+        containerStack.pop_back();
+
+        char containerHeader[5];
+        std::size_t containerHeaderSize;
+        if (closedContainer.entryCount <= 15) {
+            containerHeader[0] = static_cast<char>((closedContainer.isArray ? 0x90 : 0x80) | closedContainer.entryCount);
+            containerHeaderSize = 1;
+        }
+        else if (closedContainer.entryCount <= 0xffff) {
+            containerHeader[0] = static_cast<char>(closedContainer.isArray ? 0xdc : 0xde);
+            containerHeader[1] = static_cast<char>(closedContainer.entryCount >> 8);
+            containerHeader[2] = static_cast<char>(closedContainer.entryCount);
+            containerHeaderSize = 3;
+        }
+        else {
+            containerHeader[0] = static_cast<char>(closedContainer.isArray ? 0xdd : 0xdf);
+            for (std::size_t byteIndex = 0; byteIndex < 4; byteIndex++) {
+                containerHeader[1 + byteIndex] = static_cast<char>(closedContainer.entryCount >> ((3 - byteIndex) * 8));
+            }
+            containerHeaderSize = 5;
+        }
+        output.replaceRegion(closedContainer.headerOffset, containerPlaceholderSize, std::string_view(containerHeader, containerHeaderSize));
+    }
+
+    void appendEntryNameUnchecked(std::string_view entryName) {
+        OpenContainer& parentContainer = containerStack.back();
+        if (!parentContainer.isArray) {
+            appendStringUnchecked(entryName);
+        }
+        parentContainer.entryCount++;
+    }
+
+    void appendStringUnchecked(std::string_view text) {
+        if (text.size() < 32) {
+            output.appendUnchecked(static_cast<char>(0xa0 | text.size()));
+        }
+        else if (text.size() <= 0xff) {
+            output.appendUnchecked(static_cast<char>(0xd9));
+            output.appendBigEndianUnchecked(text.size(), 1);
+        }
+        else if (text.size() <= 0xffff) {
+            output.appendUnchecked(static_cast<char>(0xda));
+            output.appendBigEndianUnchecked(text.size(), 2);
+        }
+        else {
+            output.appendUnchecked(static_cast<char>(0xdb));
+            output.appendBigEndianUnchecked(text.size(), 4);
+        }
+        output.appendUnchecked(text);
+    }
+
+    static std::size_t getEncodedStringSize(std::string_view text) {
+        return 5 + text.size();
+    }
+
+    void appendIntegerUnchecked(int value) {
+        if (value >= 0) {
+            if (value <= 0x7f) {
+                output.appendUnchecked(static_cast<char>(value));
+            }
+            else if (value <= 0xff) {
+                output.appendUnchecked(static_cast<char>(0xcc));
+                output.appendBigEndianUnchecked(static_cast<std::uint32_t>(value), 1);
+            }
+            else if (value <= 0xffff) {
+                output.appendUnchecked(static_cast<char>(0xcd));
+                output.appendBigEndianUnchecked(static_cast<std::uint32_t>(value), 2);
+            }
+            else {
+                output.appendUnchecked(static_cast<char>(0xce));
+                output.appendBigEndianUnchecked(static_cast<std::uint32_t>(value), 4);
+            }
+        }
+        else if (value >= -32) {
+            output.appendUnchecked(static_cast<char>(value));
+        }
+        else if (value >= -128) {
+            output.appendUnchecked(static_cast<char>(0xd0));
+            output.appendBigEndianUnchecked(static_cast<std::uint8_t>(value), 1);
+        }
+        else if (value >= -32768) {
+            output.appendUnchecked(static_cast<char>(0xd1));
+            output.appendBigEndianUnchecked(static_cast<std::uint16_t>(value), 2);
+        }
+        else {
+            output.appendUnchecked(static_cast<char>(0xd2));
+            output.appendBigEndianUnchecked(static_cast<std::uint32_t>(value), 4);
+        }
+    }
+
+    void closeOpenBlocks() {
+        while (containerStack.size() > 1) {
+            closeContainer();
+        }
+    }
+
+public:
+    using Serializer::addField;
+
+    explicit MsgPackSerializer(const SerializerOptions& serializerOptions = {})
+        : options(serializerOptions), output(options.memoryResource), containerStack(options.memoryResource) {
+        reset();
+    }
+
+    void addField(std::string_view fieldName, std::string_view fieldValue) override {
+        output.reserve(getEncodedStringSize(fieldName) + getEncodedStringSize(fieldValue));
+        appendEntryNameUnchecked(fieldName);
+        appendStringUnchecked(fieldValue);
+    }
+
+    void addField(std::string_view fieldName, int fieldValue) override {
+        output.reserve(getEncodedStringSize(fieldName) + 5);
+        appendEntryNameUnchecked(fieldName);
+        appendIntegerUnchecked(fieldValue);
+    }
+
+    void addField(std::string_view fieldName, double fieldValue) override {
+        std::uint64_t valueBits;
+        std::memcpy(&valueBits, &fieldValue, sizeof(valueBits));
+        output.reserve(getEncodedStringSize(fieldName) + 9);
+        appendEntryNameUnchecked(fieldName);
+        output.appendUnchecked(static_cast<char>(0xcb));
+        output.appendBigEndianUnchecked(valueBits, 8);
+    }
+
+    void addBlock(std::string_view blockName) override {
+        output.reserve(getEncodedStringSize(blockName));
+        appendEntryNameUnchecked(blockName);
+        openContainer(false);
+    }
+
+    void endBlock() override {
+        if (containerStack.size() > 1) {
+            closeContainer();
+        }
+    }
+
+    void addArray(std::string_view arrayName) override {
+        output.reserve(getEncodedStringSize(arrayName));
+        appendEntryNameUnchecked(arrayName);
+        openContainer(true);
+    }
+
+    void endArray() override {
+        endBlock();
+    }
+
+    void reserve(std::size_t additionalSize) override {
+        output.reserveAhead(additionalSize);
+    }
+
+    std::size_t size() const override {
+        return output.size();
+    }
+
+    std::size_t nestingDepth() const override {
+        return containerStack.size() - 1;
+    }
+
+    void beginFragment(std::size_t) override {
+        output.clear();
+        containerStack.clear();
+        containerStack.push_back({ 0, 0, true });
+        isDocumentFinished = false;
+        isFragment = true;
+    }
+
+    void appendFragment(std::string_view fragment, std::size_t elementCount) override {
+        output.append(fragment);
+        containerStack.back().entryCount += static_cast<std::uint32_t>(elementCount);
+    }
+
+    std::span<char> appendFragmentSpace(std::size_t fragmentSize, std::size_t elementCount) override {
+        containerStack.back().entryCount += static_cast<std::uint32_t>(elementCount);
+        return std::span<char>(output.appendUninitialized(fragmentSize), fragmentSize);
+    }
+
+    void setOutputSink(OutputSink* targetSink) override {
+        outputSink = targetSink;
+    }
+
+    bool hasOutputSink() const override {
+        return outputSink != nullptr;
+    }
+
+    void finish() override {
+        if (!isDocumentFinished) {
+            closeOpenBlocks();
+            if (!isFragment) {
+                closeContainer();
+            }
+            isDocumentFinished = true;
+        }
+        if (outputSink != nullptr && output.size() > 0) {
+            outputSink->write(output.view());
+            output.clear();
+        }
+    }
+
+    std::string build() override {
+        finish();
+        return std::string(output.view());
+    }
+
+    void buildInto(std::string& targetBuffer) override {
+        finish();
+        targetBuffer.assign(output.view());
+    }
+
+    std::string_view buildView() override {
+        finish();
+        return output.view();
+    }
+
+    std::pmr::string buildAndRelease() override {
+        finish();
+        std::pmr::string releasedContent = output.release();
+        reset();
+        return releasedContent;
+    }
+
+    void reset() override {
+        output.clear();
+        containerStack.clear();
+        isDocumentFinished = false;
+        isFragment = false;
+        openContainer(false);
+    }
+};
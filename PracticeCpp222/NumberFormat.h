@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+enum class DoubleFormatMode {
+    Shortest,
+    FixedPrecision,
+    IntegralWithoutFraction
+};
+
+struct DoubleFormat {
+    DoubleFormatMode mode = DoubleFormatMode::Shortest;
+    int precision = 6;
+};
+
+constexpr std::size_t maxFormattedIntegerLength = 11;
+
+inline constexpr char digitPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+constexpr unsigned int firstCommonYear = 1900;
+constexpr unsigned int commonYearCount = 200;
+
+inline constexpr auto commonYearDigits = [] {
+    std::array<std::array<char, 4>, commonYearCount> yearDigits{};
+    for (unsigned int yearIndex = 0; yearIndex < commonYearCount; yearIndex++) {
+        unsigned int yearValue = firstCommonYear + yearIndex;
+        yearDigits[yearIndex][0] = static_cast<char>('0' + yearValue / 1000);
+        yearDigits[yearIndex][1] = static_cast<char>('0' + yearValue / 100 % 10);
+        yearDigits[yearIndex][2] = static_cast<char>('0' + yearValue / 10 % 10);
+        yearDigits[yearIndex][3] = static_cast<char>('0' + yearValue % 10);
+    }
+    return yearDigits;
+}();
+
+inline int countDecimalDigits(unsigned int value) {
+    int digitCount = 1;
+    while (value >= 10000) {
+        value /= 10000;
+        digitCount += 4;
+    }
+    if (value >= 1000) {
+        return digitCount + 3;
+    }
+    if (value >= 100) {
+        return digitCount + 2;
+    }
+    if (value >= 10) {
+        return digitCount + 1;
+    }
+    return digitCount;
+}
+
+// Writes at most maxFormattedIntegerLength characters and returns the new end.
+inline char* formatInteger(char* bufferBegin, int value) {
+    unsigned int magnitude = static_cast<unsigned int>(value);
+    if (value < 0) {
+        *bufferBegin++ = '-';
+        magnitude = 0u - magnitude;
+    }
+
+    if (magnitude - firstCommonYear < commonYearCount) {
+        std::memcpy(bufferBegin, commonYearDigits[magnitude - firstCommonYear].data(), 4);
+        return bufferBegin + 4;
+    }
+
+    char* bufferEnd = bufferBegin + countDecimalDigits(magnitude);
+    char* cursor = bufferEnd;
+    while (magnitude >= 100) {
+        unsigned int lowPair = magnitude % 100;
+        magnitude /= 100;
+        cursor -= 2;
+        std::memcpy(cursor, digitPairs + lowPair * 2, 2);
+    }
+    if (magnitude >= 10) {
+        std::memcpy(cursor - 2, digitPairs + magnitude * 2, 2);
+    }
+    else {
+        cursor[-1] = static_cast<char>('0' + magnitude);
+    }
+    return bufferEnd;
+}
+
+constexpr int maxDoublePrecision = 32;
+// Sign, 309 integral digits of DBL_MAX, decimal point and the fraction.
+constexpr std::size_t maxFormattedDoubleLength = 1 + 309 + 1 + maxDoublePrecision;
+
+// Shortest text that reads back as the same double. Magnitudes in [1e-5, 1e21) are
+// written without an exponent, as JavaScript's Number.toString() does, so that
+// typical weights and powers stay readable; only the rest use scientific notation.
+inline char* formatShortestDouble(char* bufferBegin, char* bufferEnd, double value) {
+    double magnitude = std::fabs(value);
+    if (magnitude == 0 || (magnitude >= 1e-5 && magnitude < 1e21)) {
+        return std::to_chars(bufferBegin, bufferEnd, value, std::chars_format::fixed).ptr;
+    }
+    return std::to_chars(bufferBegin, bufferEnd, value).ptr;
+}
+
+inline char* formatDouble(char* bufferBegin, char* bufferEnd, double value, const DoubleFormat& doubleFormat) {
+    switch (doubleFormat.mode) {
+    case DoubleFormatMode::FixedPrecision:
+        return std::to_chars(bufferBegin, bufferEnd, value, std::chars_format::fixed, std::clamp(doubleFormat.precision, 0, maxDoublePrecision)).ptr;
+    case DoubleFormatMode::IntegralWithoutFraction:
+        if (std::isfinite(value) && value == std::trunc(value)) {
+            return std::to_chars(bufferBegin, bufferEnd, value, std::chars_format::fixed).ptr;
+        }
+        return formatShortestDouble(bufferBegin, bufferEnd, value);
+    default:
+        return formatShortestDouble(bufferBegin, bufferEnd, value);
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+
+    virtual void write(std::string_view data) = 0;
+
+    // A sink backed by memory it owns, such as a file mapping, may return room for at
+    // least minimumSize bytes after what it holds. The caller fills a prefix of it and
+    // passes that length to commit(); the next call on the sink invalidates the span.
+    // Other sinks return an empty span and only take write().
+    virtual std::span<char> reserveSpan(std::size_t) {
+        return {};
+    }
+
+    virtual void commit(std::size_t) {
+    }
+};
+
+class StreamOutputSink : public OutputSink {
+private:
+    std::ostream& outputStream;
+
+public:
+    explicit StreamOutputSink(std::ostream& targetStream)
+        : outputStream(targetStream) {
+    }
+
+    void write(std::string_view data) override {
+        outputStream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!outputStream) {
+            throw std::runtime_error("Failed to write serialized output to stream");
+        }
+    }
+};
+
+// Unbuffered on its own: OutputWriter hands it data in chunks of its fixed-size buffer.
+class FileDescriptorOutputSink : public OutputSink {
+private:
+    int fileDescriptor;
+
+public:
+    explicit FileDescriptorOutputSink(int targetFileDescriptor)
+        : fileDescriptor(targetFileDescriptor) {
+    }
+
+    void write(std::string_view data) override {
+        while (!data.empty()) {
+#ifdef _WIN32
+            unsigned int chunkSize = data.size() > 0x40000000u ? 0x40000000u : static_cast<unsigned int>(data.size());
+            int writtenSize = ::_write(fileDescriptor, data.data(), chunkSize);
+#else
+            ssize_t writtenSize = ::write(fileDescriptor, data.data(), data.size());
+#endif
+            if (writtenSize < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "Failed to write serialized output to file descriptor");
+            }
+            data.remove_prefix(static_cast<std::size_t>(writtenSize));
+        }
+    }
+};
+
+class MemorySpanOutputSink : public OutputSink {
+private:
+    char* spanBegin;
+    std::size_t spanCapacity;
+    std::size_t writtenSize = 0;
+
+public:
+    MemorySpanOutputSink(char* targetBegin, std::size_t targetCapacity)
+        : spanBegin(targetBegin), spanCapacity(targetCapacity) {
+    }
+
+    void write(std::string_view data) override {
+        if (spanCapacity - writtenSize < data.size()) {
+            throw std::length_error("Serialized output does not fit into the memory span");
+        }
+        std::memcpy(spanBegin + writtenSize, data.data(), data.size());
+        writtenSize += data.size();
+    }
+
+    std::string_view view() const {
+        return std::string_view(spanBegin, writtenSize);
+    }
+
+    std::size_t size() const {
+        return writtenSize;
+    }
+
+    void clear() {
+        writtenSize = 0;
+    }
+};
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "CpuFeatures.h"
+#include "JsonEscapes.h"
+#include "NumberFormat.h"
+#include "OutputSink.h"
+#include "XmlEscapes.h"
+
+class OutputWriter {
+private:
+    static constexpr std::size_t minimumCapacity = 1024;
+    static constexpr std::size_t sinkBufferCapacity = 64 * 1024;
+    static constexpr std::string_view indentSpaces =
+        "                                                                "
+        "                                                                ";
+
+    // Output goes into buffer, which is either storage or, for sinks that support it,
+    // a region of the sink's own memory that is committed instead of written.
+    std::pmr::string storage;
+    char* buffer = nullptr;
+    std::size_t bufferCapacity = 0;
+    std::size_t writtenSize = 0;
+    OutputSink* outputSink = nullptr;
+    bool isWritingIntoSink = false;
+
+    void useStorage() {
+        isWritingIntoSink = false;
+        buffer = storage.data();
+        bufferCapacity = storage.size();
+    }
+
+    void grow(std::size_t requiredSize) {
+        storage.resize(std::max({ requiredSize, storage.size() * 2, minimumCapacity }));
+        useStorage();
+    }
+
+    // Switches to the sink's memory when it offers at least minimumSize bytes.
+    bool tryWriteIntoSink(std::size_t minimumSize) {
+        std::span<char> sinkSpan = outputSink->reserveSpan(minimumSize);
+        if (sinkSpan.size() < minimumSize || sinkSpan.empty()) {
+            return false;
+        }
+        isWritingIntoSink = true;
+        buffer = sinkSpan.data();
+        bufferCapacity = sinkSpan.size();
+        return true;
+    }
+
+public:
+    // buffer starts at the empty storage rather than null, so that appending nothing
+    // to a fresh writer is a valid zero-length copy.
+    explicit OutputWriter(std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+        : storage(memoryResource) {
+        useStorage();
+    }
+
+    // Text written before a sink that offers its memory is attached is handed to it
+    // with write(); from then on the writer fills the sink's memory directly.
+    void setSink(OutputSink* targetSink) {
+        if (isWritingIntoSink) {
+            flushToSink();
+            useStorage();
+        }
+        outputSink = targetSink;
+        if (outputSink == nullptr) {
+            return;
+        }
+        if (storage.size() < sinkBufferCapacity) {
+            storage.resize(sinkBufferCapacity);
+            useStorage();
+        }
+        flushToSink();
+        tryWriteIntoSink(1);
+    }
+
+    bool hasSink() const {
+        return outputSink != nullptr;
+    }
+
+    void flushToSink() {
+        if (outputSink != nullptr && writtenSize > 0) {
+            if (isWritingIntoSink) {
+                outputSink->commit(writtenSize);
+                bufferCapacity = 0;
+            }
+            else {
+                outputSink->write(view());
+                if (storage.size() > sinkBufferCapacity) {
+                    storage.resize(sinkBufferCapacity);
+                    storage.shrink_to_fit();
+                    useStorage();
+                }
+            }
+            writtenSize = 0;
+        }
+    }
+
+    // Makes room for additionalSize bytes of unchecked appends. A sink that only takes
+    // write() keeps the buffer at sinkBufferCapacity: it is flushed first, and grows
+    // past that only for a single append that needs more, such as a very long escaped
+    // field, until the next flush.
+    void reserve(std::size_t additionalSize) {
+        if (bufferCapacity - writtenSize < additionalSize) {
+            flushToSink();
+            if (isWritingIntoSink) {
+                if (!tryWriteIntoSink(additionalSize)) {
+                    useStorage();
+                }
+            }
+            if (bufferCapacity - writtenSize < additionalSize) {
+                if (outputSink != nullptr) {
+                    storage.resize(writtenSize + additionalSize);
+                    useStorage();
+                }
+                else {
+                    grow(writtenSize + additionalSize);
+                }
+            }
+        }
+    }
+
+    // Serializer::reserve() lands here: a hint that about additionalSize more bytes
+    // follow, not room for unchecked appends. A sink that only takes write() ignores
+    // it, since honouring it would buffer the rest of the document.
+    void reserveAhead(std::size_t additionalSize) {
+        if (outputSink != nullptr && !isWritingIntoSink) {
+            return;
+        }
+        reserve(additionalSize);
+    }
+
+    void appendUnchecked(std::string_view text) {
+        std::memcpy(buffer + writtenSize, text.data(), text.size());
+        writtenSize += text.size();
+    }
+
+    void appendUnchecked(char character) {
+        buffer[writtenSize++] = character;
+    }
+
+    void appendRepeatedUnchecked(char character, std::size_t count) {
+        std::memset(buffer + writtenSize, character, count);
+        writtenSize += count;
+    }
+
+    void appendIndentUnchecked(std::size_t indentSize) {
+        if (indentSize <= indentSpaces.size()) {
+            appendUnchecked(indentSpaces.substr(0, indentSize));
+        }
+        else {
+            appendRepeatedUnchecked(' ', indentSize);
+        }
+    }
+
+    void appendBigEndianUnchecked(std::uint64_t value, std::size_t byteCount) {
+        for (std::size_t byteIndex = byteCount; byteIndex > 0; byteIndex--) {
+            buffer[writtenSize++] = static_cast<char>(value >> ((byteIndex - 1) * 8));
+        }
+    }
+
+    void appendIntegerUnchecked(int value) {
+        char* formatEnd = formatInteger(buffer + writtenSize, value);
+        writtenSize = formatEnd - buffer;
+    }
+
+    void appendJsonEscapedUnchecked(std::string_view text, SimdLevel simdLevel) {
+        char* encodedEnd = encodeJsonEscapes(text, buffer + writtenSize, simdLevel);
+        writtenSize = encodedEnd - buffer;
+    }
+
+    void appendXmlEscapedUnchecked(std::string_view text, SimdLevel simdLevel) {
+        char* encodedEnd = encodeXmlEntities(text, buffer + writtenSize, simdLevel);
+        writtenSize = encodedEnd - buffer;
+    }
+
+    void appendDoubleUnchecked(double value, const DoubleFormat& doubleFormat) {
+        char* formatBegin = buffer + writtenSize;
+        char* formatEnd = formatDouble(formatBegin, formatBegin + maxFormattedDoubleLength, value, doubleFormat);
+        writtenSize = formatEnd - buffer;
+    }
+
+    void append(std::string_view text) {
+        if (outputSink != nullptr && !isWritingIntoSink && text.size() > storage.size()) {
+            flushToSink();
+            outputSink->write(text);
+            return;
+        }
+        reserve(text.size());
+        appendUnchecked(text);
+    }
+
+    // Appends size bytes for the caller to fill in and returns where they begin. The
+    // pointer stays valid until the writer next grows or flushes.
+    char* appendUninitialized(std::size_t size) {
+        reserve(size);
+        char* spaceBegin = buffer + writtenSize;
+        writtenSize += size;
+        return spaceBegin;
+    }
+
+    void append(char character) {
+        reserve(1);
+        appendUnchecked(character);
+    }
+
+    void appendRepeated(char character, std::size_t count) {
+        reserve(count);
+        appendRepeatedUnchecked(character, count);
+    }
+
+    void appendInteger(int value) {
+        reserve(maxFormattedIntegerLength);
+        appendIntegerUnchecked(value);
+    }
+
+    void appendDouble(double value, const DoubleFormat& doubleFormat) {
+        reserve(maxFormattedDoubleLength);
+        appendDoubleUnchecked(value, doubleFormat);
+    }
+
+    void replaceRegion(std::size_t regionOffset, std::size_t regionSize, std::string_view replacement) {
+        if (replacement.size() > regionSize) {
+            reserve(replacement.size() - regionSize);
+        }
+        char* regionBegin = buffer + regionOffset;
+        std::memmove(regionBegin + replacement.size(), regionBegin + regionSize, writtenSize - regionOffset - regionSize);
+        std::memcpy(regionBegin, replacement.data(), replacement.size());
+        writtenSize = writtenSize - regionSize + replacement.size();
+    }
+
+    std::string_view view() const {
+        return std::string_view(buffer, writtenSize);
+    }
+
+    std::size_t size() const {
+        return writtenSize;
+    }
+
+    void clear() {
+        writtenSize = 0;
+    }
+
+    // With a sink the output has gone there and the released string is empty; the
+    // writer keeps its buffer for the next document.
+    std::pmr::string release() {
+        if (outputSink != nullptr) {
+            flushToSink();
+            return std::pmr::string(storage.get_allocator());
+        }
+        storage.resize(writtenSize);
+        writtenSize = 0;
+        std::pmr::string releasedStorage = std::move(storage);
+        useStorage();
+        return releasedStorage;
+    }
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Serializer.h"
+#include "SerializerFactory.h"
+#include "SerializerOptions.h"
+#include "ThreadPool.h"
+#include "Vehicle.h"
+#include "WorkStealingExecutor.h"
+
+enum class BatchScheduling {
+    StaticChunks,
+    WorkStealing
+};
+
+// Splits a vehicle list into contiguous chunks. Each chunk is written as a fragment
+// by a serializer of its own, which keeps the fragment in place; once every size is
+// known, the document reserves room for all of them and the workers copy the
+// fragments into it in parallel, so each byte is copied once after serialization.
+// StaticChunks hands each worker exactly one chunk. WorkStealing cuts the list into
+// many smaller chunks so that workers which finish cheap records early can take over
+// chunks of expensive ones.
+class ParallelBatchSerializer {
+private:
+    static constexpr std::size_t workStealingChunksPerThread = 16;
+
+    std::unique_ptr<Serializer> targetSerializer;
+    std::string chunkFormat;
+    SerializerOptions chunkOptions;
+    std::vector<std::unique_ptr<Serializer>> chunkSerializers;
+    std::vector<std::string_view> chunkFragments;
+    std::vector<std::span<char>> chunkTargets;
+    std::vector<std::size_t> chunkOffsets;
+    BatchScheduling batchScheduling;
+    std::unique_ptr<ThreadPool> threadPool;
+    std::unique_ptr<WorkStealingExecutor> workStealingExecutor;
+
+    void serializeChunk(std::size_t chunkIndex, std::span<const Vehicle* const> vehicleList, std::size_t fragmentDepth) {
+        Serializer& chunkSerializer = *chunkSerializers[chunkIndex];
+        chunkSerializer.beginFragment(fragmentDepth);
+        for (std::size_t vehicleIndex = chunkOffsets[chunkIndex]; vehicleIndex < chunkOffsets[chunkIndex + 1]; vehicleIndex++) {
+            vehicleList[vehicleIndex]->serialize(chunkSerializer);
+        }
+        chunkFragments[chunkIndex] = chunkSerializer.buildView();
+    }
+
+    // Runs chunkTask(chunkIndex) for every chunk and waits for all of them. Under
+    // WorkStealing each chunk starts on the worker that owns its part of the list.
+    template<class ChunkTask>
+    void runChunks(std::size_t chunkCount, ChunkTask chunkTask) {
+        std::size_t workerCount = threadCount();
+        for (std::size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+            auto boundTask = [chunkTask, chunkIndex](std::size_t) {
+                chunkTask(chunkIndex);
+            };
+            if (workStealingExecutor) {
+                workStealingExecutor->submitTo(chunkIndex * workerCount / chunkCount, boundTask);
+            }
+            else {
+                threadPool->submit(boundTask);
+            }
+        }
+        if (workStealingExecutor) {
+            workStealingExecutor->waitIdle();
+        }
+        else {
+            threadPool->waitIdle();
+        }
+    }
+
+public:
+    explicit ParallelBatchSerializer(const std::string& outputFormat, std::size_t threadCount = std::thread::hardware_concurrency(), const SerializerOptions& serializerOptions = {}, BatchScheduling selectedScheduling = BatchScheduling::StaticChunks)
+        : targetSerializer(createSerializer(outputFormat, serializerOptions)), chunkFormat(outputFormat), chunkOptions(serializerOptions), batchScheduling(selectedScheduling) {
+        if (batchScheduling == BatchScheduling::WorkStealing) {
+            workStealingExecutor = std::make_unique<WorkStealingExecutor>(threadCount);
+        }
+        else {
+            threadPool = std::make_unique<ThreadPool>(threadCount);
+        }
+        // Chunks are written concurrently, so only the document serializer uses the
+        // caller's memory resource; an arena is usually not synchronized.
+        chunkOptions.memoryResource = std::pmr::get_default_resource();
+    }
+
+    Serializer& documentSerializer() {
+        return *targetSerializer;
+    }
+
+    std::size_t threadCount() const {
+        return workStealingExecutor ? workStealingExecutor->size() : threadPool->size();
+    }
+
+    BatchScheduling scheduling() const {
+        return batchScheduling;
+    }
+
+    void serializeVehicles(std::span<const Vehicle* const> vehicleList) {
+        using namespace std::string_view_literals;
+
+        targetSerializer->addArray("vehicles"sv);
+        std::size_t fragmentDepth = targetSerializer->nestingDepth();
+
+        std::size_t chunkCount = batchScheduling == BatchScheduling::WorkStealing ? threadCount() * workStealingChunksPerThread : threadCount();
+        chunkCount = std::min(chunkCount, vehicleList.size());
+        while (chunkSerializers.size() < chunkCount) {
+            chunkSerializers.push_back(createSerializer(chunkFormat, chunkOptions));
+        }
+        chunkFragments.resize(chunkCount);
+        chunkTargets.resize(chunkCount);
+        chunkOffsets.resize(chunkCount + 1);
+        for (std::size_t chunkIndex = 0; chunkIndex <= chunkCount; chunkIndex++) {
+            chunkOffsets[chunkIndex] = chunkCount == 0 ? 0 : vehicleList.size() * chunkIndex / chunkCount;
+        }
+
+        runChunks(chunkCount, [this, vehicleList, fragmentDepth](std::size_t chunkIndex) {
+            serializeChunk(chunkIndex, vehicleList, fragmentDepth);
+        });
+
+        // A sink streams through a fixed-size buffer that cannot hold every fragment at
+        // once, so there the fragments are written one after another instead.
+        if (targetSerializer->hasOutputSink()) {
+            for (std::size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+                targetSerializer->appendFragment(chunkFragments[chunkIndex], chunkOffsets[chunkIndex + 1] - chunkOffsets[chunkIndex]);
+            }
+            targetSerializer->endArray();
+            return;
+        }
+
+        std::size_t documentSize = 0;
+        for (std::size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+            documentSize += chunkFragments[chunkIndex].size() + 1;
+        }
+        targetSerializer->reserve(documentSize);
+        for (std::size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+            chunkTargets[chunkIndex] = targetSerializer->appendFragmentSpace(chunkFragments[chunkIndex].size(), chunkOffsets[chunkIndex + 1] - chunkOffsets[chunkIndex]);
+        }
+        runChunks(chunkCount, [this](std::size_t chunkIndex) {
+            if (!chunkTargets[chunkIndex].empty()) {
+                std::memcpy(chunkTargets[chunkIndex].data(), chunkFragments[chunkIndex].data(), chunkTargets[chunkIndex].size());
+            }
+        });
+        targetSerializer->endArray();
+    }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "OutputSink.h"
+#include "StringInternTable.h"
+
+class Serializer {
+public:
+    virtual ~Serializer() = default;
+
+    virtual void addField(std::string_view fieldName, std::string_view fieldValue) = 0;
+    virtual void addField(std::string_view fieldName, int fieldValue) = 0;
+    virtual void addField(std::string_view fieldName, double fieldValue) = 0;
+
+    // Text formats override this to copy the value's cached escaped form.
+    virtual void addField(std::string_view fieldName, const InternedString& fieldValue) {
+        addField(fieldName, fieldValue.view());
+    }
+
+    virtual void addBlock(std::string_view blockName) = 0;
+    virtual void endBlock() = 0;
+
+    virtual void addArray(std::string_view arrayName) = 0;
+    virtual void endArray() = 0;
+
+    // A hint that about additionalSize more bytes follow. While a sink that only takes
+    // write() is attached the output stays in a fixed-size buffer and it is ignored.
+    virtual void reserve(std::size_t additionalSize) = 0;
+    virtual std::size_t size() const = 0;
+    virtual std::size_t nestingDepth() const = 0;
+
+    // A fragment holds array elements serialized as if they were written at
+    // nestingDepth inside an open array, without any document framing. Fragments
+    // built by separate serializers are spliced into a document with appendFragment().
+    virtual void beginFragment(std::size_t fragmentDepth) = 0;
+    virtual void appendFragment(std::string_view fragment, std::size_t elementCount) = 0;
+
+    // Splices a fragment like appendFragment() but leaves its bytes for the caller to
+    // copy into the returned span later, possibly from another thread. When reserve()
+    // has made room for all of them first, the spans stay valid until the next call
+    // other than appendFragmentSpace(). Under a sink that only takes write() reserve()
+    // makes no such room, so callers streaming to a sink use appendFragment().
+    virtual std::span<char> appendFragmentSpace(std::size_t fragmentSize, std::size_t elementCount) = 0;
+
+    virtual void setOutputSink(OutputSink* outputSink) = 0;
+    virtual bool hasOutputSink() const = 0;
+    virtual void finish() = 0;
+
+    virtual std::string build() = 0;
+    virtual void buildInto(std::string& targetBuffer) = 0;
+    virtual std::pmr::string buildAndRelease() = 0;
+
+    // Finishes the document and returns it in place. The view is valid until the
+    // serializer is next changed; with a sink attached it holds only what was not
+    // written to the sink yet.
+    virtual std::string_view buildView() = 0;
+
+    virtual void reset() = 0;
+};
+
+// Called once the first of a run of similar elements has been written: reserves room
+// for the remaining ones from its size, plus an eighth for variation between them.
+// Nothing is reserved while a sink is attached, since the output then streams through
+// a fixed-size buffer and the estimate would hold the whole document in memory again.
+inline void reserveForRemainingElements(Serializer& serializer, std::size_t firstElementSize, std::size_t remainingCount) {
+    if (serializer.hasOutputSink()) {
+        return;
+    }
+    serializer.reserve(firstElementSize + firstElementSize * remainingCount * 9 / 8);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "CborSerializer.h"
+#include "JsonSerializer.h"
+#include "MetricsSerializer.h"
+#include "MsgPackSerializer.h"
+#include "Serializer.h"
+#include "SerializerOptions.h"
+#include "XmlSerializer.h"
+
+inline std::unique_ptr<Serializer> createSerializer(const std::string& outputFormat, const SerializerOptions& serializerOptions = {}) {
+    if (serializerOptions.collectMetrics) {
+        return std::make_unique<MetricsSerializer>(serializerOptions, [&](const SerializerOptions& innerOptions) {
+            return createSerializer(outputFormat, innerOptions);
+        });
+    }
+    if (outputFormat == "xml") {
+        if (!serializerOptions.pretty) {
+            return std::make_unique<CompactXmlSerializer>(serializerOptions);
+        }
+        return std::make_unique<XmlSerializer>(serializerOptions);
+    }
+    else if (outputFormat == "json") {
+        if (!serializerOptions.pretty) {
+            return std::make_unique<CompactJsonSerializer>(serializerOptions);
+        }
+        return std::make_unique<JsonSerializer>(serializerOptions);
+    }
+    else if (outputFormat == "msgpack") {
+        return std::make_unique<MsgPackSerializer>(serializerOptions);
+    }
+    else if (outputFormat == "cbor") {
+        return std::make_unique<CborSerializer>(serializerOptions);
+    }
+    throw std::invalid_argument("Unsupported format: " + outputFormat);
+}
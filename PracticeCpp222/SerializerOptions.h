@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory_resource>
+
+#include "CpuFeatures.h"
+#include "NumberFormat.h"
+
+struct SerializerOptions {
+    DoubleFormat doubleFormat;
+    bool pretty = true;
+    // Text formats escape string values; JSON also escapes field names and XML rejects
+    // names that are not valid element names. Turning this off writes everything
+    // verbatim, which is only safe when every string is known to need no escapes.
+    bool escapeStrings = true;
+    // The widest instruction set the escapers may use; clamped to what the CPU supports.
+    SimdLevel simdLevel = SimdLevel::Avx2;
+    // Makes createSerializer() wrap the serializer in a MetricsSerializer.
+    bool collectMetrics = false;
+    // Backs the output buffer and the bookkeeping containers of the serializer.
+    std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource();
+};
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+#include "CpuFeatures.h"
+#include "FieldKey.h"
+#include "JsonEscapes.h"
+#include "NumberFormat.h"
+#include "OutputSink.h"
+#include "OutputWriter.h"
+#include "SerializerOptions.h"
+#include "StringInternTable.h"
+#include "XmlEscapes.h"
+
+// Compile-time counterparts of JsonSerializer and XmlSerializer for callers that
+// know the vehicle type. Depth and field names are template parameters, so the
+// indentation and tags around every value fold into one constant string that is
+// copied with a single memcpy.
+
+template<std::size_t Capacity>
+struct StaticText {
+    char text[Capacity]{};
+    std::size_t length = 0;
+
+    constexpr void append(std::string_view part) {
+        for (char partChar : part) {
+            text[length++] = partChar;
+        }
+    }
+
+    constexpr void appendRepeated(char repeatedChar, std::size_t count) {
+        for (std::size_t charIndex = 0; charIndex < count; charIndex++) {
+            text[length++] = repeatedChar;
+        }
+    }
+
+    constexpr std::string_view view() const {
+        return std::string_view(text, length);
+    }
+};
+
+template<int Depth, StaticKey Name, StaticKey Suffix>
+inline constexpr auto jsonFieldPrefix = [] {
+    static_assert(isJsonLiteralSafe(Name.view()), "Field and block names must not need JSON escaping");
+    StaticText<2 + Depth * 2 + Name.length + 4 + Suffix.length> prefixText;
+    prefixText.append(",\n");
+    prefixText.appendRepeated(' ', Depth * 2);
+    prefixText.append("\"");
+    prefixText.append(Name.view());
+    prefixText.append("\": ");
+    prefixText.append(Suffix.view());
+    return prefixText;
+}();
+
+template<int Depth>
+inline constexpr auto jsonBlockClosing = [] {
+    StaticText<1 + (Depth - 1) * 2 + 1> closingText;
+    closingText.append("\n");
+    closingText.appendRepeated(' ', (Depth - 1) * 2);
+    closingText.append("}");
+    return closingText;
+}();
+
+template<int Depth>
+class StaticJsonBlock {
+private:
+    OutputWriter& output;
+    const SerializerOptions& options;
+    bool isCommaNeeded = false;
+
+    template<StaticKey Name, StaticKey Suffix>
+    void appendFieldPrefixUnchecked() {
+        constexpr std::string_view prefixText = jsonFieldPrefix<Depth, Name, Suffix>.view();
+        output.appendUnchecked(isCommaNeeded ? prefixText : prefixText.substr(1));
+        isCommaNeeded = true;
+    }
+
+public:
+    StaticJsonBlock(OutputWriter& targetOutput, const SerializerOptions& serializerOptions)
+        : output(targetOutput), options(serializerOptions) {
+    }
+
+    void reset() {
+        isCommaNeeded = false;
+    }
+
+    template<StaticKey Name>
+    void addField(FieldKey<Name>, std::string_view fieldValue) {
+        output.reserve(jsonFieldPrefix<Depth, Name, "\"">.length + fieldValue.size() * maxJsonEscapeExpansion + 1);
+        appendFieldPrefixUnchecked<Name, "\"">();
+        if (options.escapeStrings) {
+            output.appendJsonEscapedUnchecked(fieldValue, options.simdLevel);
+        }
+        else {
+            output.appendUnchecked(fieldValue);
+        }
+        output.appendUnchecked('"');
+    }
+
+    template<StaticKey Name>
+    void addField(FieldKey<Name>, int fieldValue) {
+        output.reserve(jsonFieldPrefix<Depth, Name, "">.length + maxFormattedIntegerLength);
+        appendFieldPrefixUnchecked<Name, "">();
+        output.appendIntegerUnchecked(fieldValue);
+    }
+
+    template<StaticKey Name>
+    void addField(FieldKey<Name>, double fieldValue) {
+        output.reserve(jsonFieldPrefix<Depth, Name, "">.length + maxFormattedDoubleLength);
+        appendFieldPrefixUnchecked<Name, "">();
+        output.appendDoubleUnchecked(fieldValue, options.doubleFormat);
+    }
+
+    template<StaticKey Name>
+    void addField(FieldKey<Name>, const InternedString& fieldValue) {
+        std::string_view escapedValue = fieldValue.interned().jsonEscapedText;
+        output.reserve(jsonFieldPrefix<Depth, Name, "\"">.length + escapedValue.size() + 1);
+        appendFieldPrefixUnchecked<Name, "\"">();
+        output.appendUnchecked(escapedValue);
+        output.appendUnchecked('"');
+    }
+
+    template<StaticKey Name>
+    StaticJsonBlock<Depth + 1> addBlock(FieldKey<Name>) {
+        output.reserve(jsonFieldPrefix<Depth, Name, "{">.length);
+        appendFieldPrefixUnchecked<Name, "{">();
+        return StaticJsonBlock<Depth + 1>(output, options);
+    }
+
+    void endBlock() {
+        static_assert(Depth > 0, "The document root is closed by StaticJsonSerializer::finish()");
+        output.append(jsonBlockClosing<Depth>.view());
+    }
+};
+
+template<int Depth, StaticKey Name>
+inline constexpr auto xmlFieldOpening = [] {
+    static_assert(isXmlName(Name.view()), "Field and block names must be valid XML element names");
+    StaticText<Depth * 2 + Name.length + 2> openingText;
+    openingText.appendRepeated(' ', Depth * 2);
+    openingText.append("<");
+    openingText.append(Name.view());
+    openingText.append(">");
+    return openingText;
+}();
+
+template<int Depth, StaticKey Name>
+inline constexpr auto xmlBlockOpening = [] {
+    StaticText<Depth * 2 + Name.length + 3> openingText;
+    openingText.append(xmlFieldOpening<Depth, Name>.view());
+    openingText.append("\n");
+    return openingText;
+}();
+
+template<StaticKey Name>
+inline constexpr auto xmlFieldClosing = [] {
+    StaticText<Name.length + 4> closingText;
+    closingText.append("</");
+    closingText.append(Name.view());
+    closingText.append(">\n");
+    return closingText;
+}();
+
+template<int Depth, StaticKey Name>
+inline constexpr auto xmlBlockClosing = [] {
+    StaticText<(Depth - 1) * 2 + Name.length + 4> closingText;
+    closingText.appendRepeated(' ', (Depth - 1) * 2);
+    closingText.append(xmlFieldClosing<Name>.view());
+    return closingText;
+}();
+
+template<int Depth, StaticKey BlockName = "">
+class StaticXmlBlock {
+private:
+    OutputWriter& output;
+    const SerializerOptions& options;
+
+public:
+    StaticXmlBlock(OutputWriter& targetOutput, const SerializerOptions& serializerOptions)
+        : output(targetOutput), options(serializerOptions) {
+    }
+
+    void reset() {
+    }
+
+    template<StaticKey Name>
+    void addField(FieldKey<Name>, std::string_view fieldValue) {
+        output.reserve(xmlFieldOpening<Depth, Name>.length + fieldValue.size() * maxXmlEscapeExpansion + xmlFieldClosing<Name>.length);
+        output.appendUnchecked(xmlFieldOpening<Depth, Name>.view());
+        if (options.escapeStrings) {
+            output.appendXmlEscapedUnchecked(fieldValue, options.simdLevel);
+        }
+        else {
+            output.appendUnchecked(fieldValue);
+        }
+        output.appendUnchecked(xmlFieldClosing<Name>.view());
+    }
+
+    template<StaticKey Name>
+    void addField(FieldKey<Name>, int fieldValue) {
+        output.reserve(xmlFieldOpening<Depth, Name>.length + maxFormattedIntegerLength + xmlFieldClosing<Name>.length);
+        output.appendUnchecked(xmlFieldOpening<Depth, Name>.view());
+        output.appendIntegerUnchecked(fieldValue);
+        output.appendUnchecked(xmlFieldClosing<Name>.view());
+    }
+
+    template<StaticKey Name>
+    void addField(FieldKey<Name>, double fieldValue) {
+        output.reserve(xmlFieldOpening<Depth, Name>.length + maxFormattedDoubleLength + xmlFieldClosing<Name>.length);
+        output.appendUnchecked(xmlFieldOpening<Depth, Name>.view());
+        output.appendDoubleUnchecked(fieldValue, options.doubleFormat);
+        output.appendUnchecked(xmlFieldClosing<Name>.view());
+    }
+
+    template<StaticKey Name>
+    void addField(FieldKey<Name>, const InternedString& fieldValue) {
+        std::string_view escapedValue = fieldValue.interned().xmlEscapedText;
+        output.reserve(xmlFieldOpening<Depth, Name>.length + escapedValue.size() + xmlFieldClosing<Name>.length);
+        output.appendUnchecked(xmlFieldOpening<Depth, Name>.view());
+        output.appendUnchecked(escapedValue);
+        output.appendUnchecked(xmlFieldClosing<Name>.view());
+    }
+
+    template<StaticKey Name>
+    StaticXmlBlock<Depth + 1, Name> addBlock(FieldKey<Name>) {
+        output.append(xmlBlockOpening<Depth, Name>.view());
+        return StaticXmlBlock<Depth + 1, Name>(output, options);
+    }
+
+    void endBlock() {
+        static_assert(Depth > 0, "The document root has no closing tag");
+        output.append(xmlBlockClosing<Depth, BlockName>.view());
+    }
+};
+
+template<class RootBlock, StaticKey DocumentOpening, StaticKey DocumentClosing>
+class StaticDocumentSerializer {
+private:
+    SerializerOptions options;
+    OutputWriter output;
+    RootBlock rootBlock;
+    bool isDocumentFinished = false;
+
+public:
+    explicit StaticDocumentSerializer(const SerializerOptions& serializerOptions = {})
+        : options(serializerOptions), output(options.memoryResource), rootBlock(output, options) {
+        options.simdLevel = limitSimdLevel(options.simdLevel);
+        reset();
+    }
+
+    StaticDocumentSerializer(const StaticDocumentSerializer&) = delete;
+    StaticDocumentSerializer& operator=(const StaticDocumentSerializer&) = delete;
+
+    RootBlock& document() {
+        return rootBlock;
+    }
+
+    void setOutputSink(OutputSink* outputSink) {
+        output.setSink(outputSink);
+    }
+
+    void finish() {
+        if (!isDocumentFinished) {
+            output.append(DocumentClosing.view());
+            isDocumentFinished = true;
+        }
+        output.flushToSink();
+    }
+
+    std::string build() {
+        finish();
+        return std::string(output.view());
+    }
+
+    void buildInto(std::string& targetBuffer) {
+        finish();
+        targetBuffer.assign(output.view());
+    }
+
+    std::pmr::string buildAndRelease() {
+        finish();
+        std::pmr::string releasedContent = output.release();
+        reset();
+        return releasedContent;
+    }
+
+    void reset() {
+        output.clear();
+        output.append(DocumentOpening.view());
+        rootBlock.reset();
+        isDocumentFinished = false;
+    }
+};
+
+using StaticJsonSerializer = StaticDocumentSerializer<StaticJsonBlock<0>, "{\n", "\n}">;
+using StaticXmlSerializer = StaticDocumentSerializer<StaticXmlBlock<0>, "", "">;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Maps each distinct string to a dense 32-bit id. Views returned by text() point at
+// the hash map's own keys, whose nodes never move, so they stay valid for the
+// lifetime of the dictionary. Moving keeps them valid; copying would not, so the
+// dictionary is move-only.
+class StringDictionary {
+private:
+    struct TextHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view text) const {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+
+    std::unordered_map<std::string, std::uint32_t, TextHash, std::equal_to<>> idsByText;
+    std::vector<std::string_view> textsById;
+
+public:
+    StringDictionary() = default;
+    StringDictionary(const StringDictionary&) = delete;
+    StringDictionary& operator=(const StringDictionary&) = delete;
+    StringDictionary(StringDictionary&&) = default;
+    StringDictionary& operator=(StringDictionary&&) = default;
+
+    std::uint32_t intern(std::string_view text) {
+        auto existingEntry = idsByText.find(text);
+        if (existingEntry != idsByText.end()) {
+            return existingEntry->second;
+        }
+        auto insertedEntry = idsByText.emplace(std::string(text), static_cast<std::uint32_t>(textsById.size())).first;
+        textsById.push_back(insertedEntry->first);
+        return insertedEntry->second;
+    }
+
+    std::string_view text(std::uint32_t textId) const {
+        return textsById[textId];
+    }
+
+    std::size_t size() const {
+        return textsById.size();
+    }
+
+    void clear() {
+        idsByText.clear();
+        textsById.clear();
+    }
+};
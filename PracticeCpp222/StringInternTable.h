@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "JsonEscapes.h"
+#include "XmlEscapes.h"
+
+// One distinct value of a StringInternTable. The escaped forms are computed once when
+// the value is interned, so text serializers copy them verbatim.
+struct InternedText {
+    std::string text;
+    std::string jsonEscapedText;
+    std::string xmlEscapedText;
+};
+
+// A concurrent, read-mostly set of distinct strings. Looking up a value that is
+// already interned only takes a shared lock; a miss retries under the exclusive lock
+// and appends the value. Entries are never moved or removed, so references to them
+// stay valid for the lifetime of the table.
+class StringInternTable {
+private:
+    mutable std::shared_mutex tableMutex;
+    std::deque<InternedText> entries;
+    std::unordered_map<std::string_view, const InternedText*> entriesByText;
+
+    const InternedText* find(std::string_view text) const {
+        auto existingEntry = entriesByText.find(text);
+        return existingEntry != entriesByText.end() ? existingEntry->second : nullptr;
+    }
+
+public:
+    StringInternTable() = default;
+    StringInternTable(const StringInternTable&) = delete;
+    StringInternTable& operator=(const StringInternTable&) = delete;
+
+    // The table InternedStrings use unless they are constructed with another.
+    static StringInternTable& global() {
+        static StringInternTable globalTable;
+        return globalTable;
+    }
+
+    const InternedText& intern(std::string_view text) {
+        {
+            std::shared_lock readLock(tableMutex);
+            if (const InternedText* existingText = find(text)) {
+                return *existingText;
+            }
+        }
+        std::unique_lock writeLock(tableMutex);
+        if (const InternedText* existingText = find(text)) {
+            return *existingText;
+        }
+        InternedText& internedText = entries.emplace_back();
+        internedText.text.assign(text);
+        encodeJsonEscapes(text, internedText.jsonEscapedText);
+        encodeXmlEntities(text, internedText.xmlEscapedText);
+        entriesByText.emplace(internedText.text, &internedText);
+        return internedText;
+    }
+
+    std::size_t size() const {
+        std::shared_lock readLock(tableMutex);
+        return entries.size();
+    }
+};
+
+// A string field whose value lives in a StringInternTable: a pointer to the value and
+// one to the table that owns it, copied without allocating. Assigning a plain string
+// interns it into the same table, which is the global one unless the handle was
+// constructed with another; that table must then outlive the handle.
+class InternedString {
+private:
+    static inline const InternedText emptyText{};
+
+    const InternedText* internedText = &emptyText;
+    StringInternTable* internTable = &StringInternTable::global();
+
+public:
+    InternedString() = default;
+
+    explicit InternedString(StringInternTable& owningTable)
+        : internTable(&owningTable) {
+    }
+
+    InternedString(std::string_view text, StringInternTable& owningTable)
+        : internedText(&owningTable.intern(text)), internTable(&owningTable) {
+    }
+
+    InternedString& operator=(std::string_view text) {
+        internedText = &internTable->intern(text);
+        return *this;
+    }
+
+    StringInternTable& table() const {
+        return *internTable;
+    }
+
+    const InternedText& interned() const {
+        return *internedText;
+    }
+
+    std::string_view view() const {
+        return internedText->text;
+    }
+
+    operator std::string_view() const {
+        return internedText->text;
+    }
+
+    std::size_t size() const {
+        return internedText->text.size();
+    }
+
+    bool empty() const {
+        return internedText->text.empty();
+    }
+
+    friend bool operator==(const InternedString& leftString, const InternedString& rightString) {
+        return leftString.internedText == rightString.internedText || leftString.view() == rightString.view();
+    }
+
+    friend bool operator==(const InternedString& internedString, std::string_view text) {
+        return internedString.view() == text;
+    }
+};
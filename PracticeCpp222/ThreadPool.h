@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workerThreads;
+    std::deque<std::function<void(std::size_t)>> taskQueue;
+    std::mutex queueMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allTasksDone;
+    std::size_t unfinishedTaskCount = 0;
+    std::exception_ptr firstTaskError;
+    bool isStopping = false;
+
+    void runWorker(std::size_t workerIndex) {
+        while (true) {
+            std::function<void(std::size_t)> nextTask;
+            {
+                std::unique_lock<std::mutex> queueLock(queueMutex);
+                taskAvailable.wait(queueLock, [this] { return isStopping || !taskQueue.empty(); });
+                if (taskQueue.empty()) {
+                    return;
+                }
+                nextTask = std::move(taskQueue.front());
+                taskQueue.pop_front();
+            }
+
+            std::exception_ptr taskError;
+            try {
+                nextTask(workerIndex);
+            }
+            catch (...) {
+                taskError = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> queueLock(queueMutex);
+            if (taskError && !firstTaskError) {
+                firstTaskError = std::move(taskError);
+            }
+            if (--unfinishedTaskCount == 0) {
+                allTasksDone.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(std::size_t threadCount) {
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+        workerThreads.reserve(threadCount);
+        for (std::size_t workerIndex = 0; workerIndex < threadCount; workerIndex++) {
+            workerThreads.emplace_back([this, workerIndex] { runWorker(workerIndex); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> queueLock(queueMutex);
+            isStopping = true;
+        }
+        taskAvailable.notify_all();
+        for (std::thread& workerThread : workerThreads) {
+            workerThread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const {
+        return workerThreads.size();
+    }
+
+    void submit(std::function<void(std::size_t workerIndex)> task) {
+        {
+            std::lock_guard<std::mutex> queueLock(queueMutex);
+            taskQueue.push_back(std::move(task));
+            unfinishedTaskCount++;
+        }
+        taskAvailable.notify_one();
+    }
+
+    // Blocks until every submitted task has run and rethrows the first task failure.
+    void waitIdle() {
+        std::unique_lock<std::mutex> queueLock(queueMutex);
+        allTasksDone.wait(queueLock, [this] { return unfinishedTaskCount == 0; });
+        if (firstTaskError) {
+            std::exception_ptr taskError = std::exchange(firstTaskError, nullptr);
+            std::rethrow_exception(taskError);
+        }
+    }
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Writes up to four bytes and returns how many were written.
+inline std::size_t encodeUtf8(std::uint32_t codePoint, char* outputBuffer) {
+    if (codePoint < 0x80) {
+        outputBuffer[0] = static_cast<char>(codePoint);
+        return 1;
+    }
+    else if (codePoint < 0x800) {
+        outputBuffer[0] = static_cast<char>(0xc0 | (codePoint >> 6));
+        outputBuffer[1] = static_cast<char>(0x80 | (codePoint & 0x3f));
+        return 2;
+    }
+    else if (codePoint < 0x10000) {
+        outputBuffer[0] = static_cast<char>(0xe0 | (codePoint >> 12));
+        outputBuffer[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        outputBuffer[2] = static_cast<char>(0x80 | (codePoint & 0x3f));
+        return 3;
+    }
+    outputBuffer[0] = static_cast<char>(0xf0 | (codePoint >> 18));
+    outputBuffer[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+    outputBuffer[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+    outputBuffer[3] = static_cast<char>(0x80 | (codePoint & 0x3f));
+    return 4;
+}
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "Deserializer.h"
+#include "FieldKey.h"
+#include "Serializer.h"
+#include "StringInternTable.h"
+
+enum class VehicleKind : std::uint8_t {
+    Car,
+    Airplane,
+    Ship
+};
+
+// Vehicles are allocator-aware: their model names live in the memory resource passed
+// at construction, and std::pmr containers hand their own resource down to the
+// vehicles they hold. Without a resource the default one is used, as before.
+// Attributes with few distinct values are InternedStrings and never allocate per vehicle.
+class Vehicle {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    std::pmr::string modelName;
+    InternedString manufacturerName;
+    double vehicleWeight;
+    double enginePower;
+    int productionYear;
+
+    Vehicle() = default;
+
+    explicit Vehicle(const allocator_type& allocator)
+        : modelName(allocator) {
+    }
+
+    Vehicle(const Vehicle& other, const allocator_type& allocator)
+        : modelName(other.modelName, allocator), manufacturerName(other.manufacturerName),
+        vehicleWeight(other.vehicleWeight), enginePower(other.enginePower), productionYear(other.productionYear) {
+    }
+
+    Vehicle(Vehicle&& other, const allocator_type& allocator)
+        : modelName(std::move(other.modelName), allocator), manufacturerName(other.manufacturerName),
+        vehicleWeight(other.vehicleWeight), enginePower(other.enginePower), productionYear(other.productionYear) {
+    }
+
+    Vehicle(const Vehicle&) = default;
+    Vehicle(Vehicle&&) = default;
+    Vehicle& operator=(const Vehicle&) = default;
+    Vehicle& operator=(Vehicle&&) = default;
+    virtual ~Vehicle() = default;
+
+    virtual void serialize(Serializer& serializer) const = 0;
+    // Reads everything serialize() writes after the "type" field; the enclosing
+    // "vehicle" block and the type are consumed by deserializeVehicle().
+    virtual void deserialize(Deserializer& deserializer) = 0;
+
+    allocator_type get_allocator() const {
+        return modelName.get_allocator();
+    }
+};
+
+class Car final : public Vehicle {
+public:
+    int doorCount;
+    int passengerSeatCount;
+    InternedString fuelType;
+    double engineVolume;
+
+    Car() = default;
+
+    explicit Car(const allocator_type& allocator)
+        : Vehicle(allocator) {
+    }
+
+    Car(const Car& other, const allocator_type& allocator)
+        : Vehicle(other, allocator), doorCount(other.doorCount), passengerSeatCount(other.passengerSeatCount),
+        fuelType(other.fuelType), engineVolume(other.engineVolume) {
+    }
+
+    Car(Car&& other, const allocator_type& allocator)
+        : Vehicle(std::move(other), allocator), doorCount(other.doorCount), passengerSeatCount(other.passengerSeatCount),
+        fuelType(other.fuelType), engineVolume(other.engineVolume) {
+    }
+
+    Car(const Car&) = default;
+    Car(Car&&) = default;
+    Car& operator=(const Car&) = default;
+    Car& operator=(Car&&) = default;
+
+    void serialize(Serializer& serializer) const override {
+        using namespace std::string_view_literals;
+
+        serializer.addBlock("vehicle"sv);
+        serializer.addField("type"sv, "Car"sv);
+        serializer.addField("name"sv, modelName);
+        serializer.addField("manufacturer"sv, manufacturerName);
+        serializer.addField("weight"sv, vehicleWeight);
+        serializer.addField("power"sv, enginePower);
+        serializer.addField("year"sv, productionYear);
+
+        serializer.addBlock("carSpecific"sv);
+        serializer.addField("doors"sv, doorCount);
+        serializer.addField("passengerSeats"sv, passengerSeatCount);
+        serializer.addField("fuelType"sv, fuelType);
+        serializer.addField("engineVolume"sv, engineVolume);
+        serializer.endBlock();
+
+        serializer.endBlock();
+    }
+
+    void deserialize(Deserializer& deserializer) override {
+        using namespace std::string_view_literals;
+
+        deserializer.readField("name"sv, modelName);
+        deserializer.readField("manufacturer"sv, manufacturerName);
+        deserializer.readField("weight"sv, vehicleWeight);
+        deserializer.readField("power"sv, enginePower);
+        deserializer.readField("year"sv, productionYear);
+
+        deserializer.enterBlock("carSpecific"sv);
+        deserializer.readField("doors"sv, doorCount);
+        deserializer.readField("passengerSeats"sv, passengerSeatCount);
+        deserializer.readField("fuelType"sv, fuelType);
+        deserializer.readField("engineVolume"sv, engineVolume);
+        deserializer.exitBlock();
+    }
+
+    template<class BlockWriter>
+    void serializeTo(BlockWriter& blockWriter) const {
+        using namespace std::string_view_literals;
+
+        auto vehicleBlock = blockWriter.addBlock(fieldKey<"vehicle">);
+        vehicleBlock.addField(fieldKey<"type">, "Car"sv);
+        vehicleBlock.addField(fieldKey<"name">, modelName);
+        vehicleBlock.addField(fieldKey<"manufacturer">, manufacturerName);
+        vehicleBlock.addField(fieldKey<"weight">, vehicleWeight);
+        vehicleBlock.addField(fieldKey<"power">, enginePower);
+        vehicleBlock.addField(fieldKey<"year">, productionYear);
+
+        auto specificBlock = vehicleBlock.addBlock(fieldKey<"carSpecific">);
+        specificBlock.addField(fieldKey<"doors">, doorCount);
+        specificBlock.addField(fieldKey<"passengerSeats">, passengerSeatCount);
+        specificBlock.addField(fieldKey<"fuelType">, fuelType);
+        specificBlock.addField(fieldKey<"engineVolume">, engineVolume);
+        specificBlock.endBlock();
+
+        vehicleBlock.endBlock();
+    }
+};
+
+class Airplane final : public Vehicle {
+public:
+    int wingSpan;
+    int maxAltitude;
+    int maxPassengerCapacity;
+    double maxSpeed;
+
+    Airplane() = default;
+
+    explicit Airplane(const allocator_type& allocator)
+        : Vehicle(allocator) {
+    }
+
+    Airplane(const Airplane& other, const allocator_type& allocator)
+        : Vehicle(other, allocator), wingSpan(other.wingSpan), maxAltitude(other.maxAltitude),
+        maxPassengerCapacity(other.maxPassengerCapacity), maxSpeed(other.maxSpeed) {
+    }
+
+    Airplane(Airplane&& other, const allocator_type& allocator)
+        : Vehicle(std::move(other), allocator), wingSpan(other.wingSpan), maxAltitude(other.maxAltitude),
+        maxPassengerCapacity(other.maxPassengerCapacity), maxSpeed(other.maxSpeed) {
+    }
+
+    Airplane(const Airplane&) = default;
+    Airplane(Airplane&&) = default;
+    Airplane& operator=(const Airplane&) = default;
+    Airplane& operator=(Airplane&&) = default;
+
+    void serialize(Serializer& serializer) const override {
+        using namespace std::string_view_literals;
+
+        serializer.addBlock("vehicle"sv);
+        serializer.addField("type"sv, "Airplane"sv);
+        serializer.addField("name"sv, modelName);
+        serializer.addField("manufacturer"sv, manufacturerName);
+        serializer.addField("weight"sv, vehicleWeight);
+        serializer.addField("power"sv, enginePower);
+        serializer.addField("year"sv, productionYear);
+
+        serializer.addBlock("airplaneSpecific"sv);
+        serializer.addField("wingspan"sv, wingSpan);
+        serializer.addField("maxAltitude"sv, maxAltitude);
+        serializer.addField("passengerCapacity"sv, maxPassengerCapacity);
+        serializer.addField("maxSpeed"sv, maxSpeed);
+        serializer.endBlock();
+
+        serializer.endBlock();
+    }
+
+    void deserialize(Deserializer& deserializer) override {
+        using namespace std::string_view_literals;
+
+        deserializer.readField("name"sv, modelName);
+        deserializer.readField("manufacturer"sv, manufacturerName);
+        deserializer.readField("weight"sv, vehicleWeight);
+        deserializer.readField("power"sv, enginePower);
+        deserializer.readField("year"sv, productionYear);
+
+        deserializer.enterBlock("airplaneSpecific"sv);
+        deserializer.readField("wingspan"sv, wingSpan);
+        deserializer.readField("maxAltitude"sv, maxAltitude);
+        deserializer.readField("passengerCapacity"sv, maxPassengerCapacity);
+        deserializer.readField("maxSpeed"sv, maxSpeed);
+        deserializer.exitBlock();
+    }
+
+    template<class BlockWriter>
+    void serializeTo(BlockWriter& blockWriter) const {
+        using namespace std::string_view_literals;
+
+        auto vehicleBlock = blockWriter.addBlock(fieldKey<"vehicle">);
+        vehicleBlock.addField(fieldKey<"type">, "Airplane"sv);
+        vehicleBlock.addField(fieldKey<"name">, modelName);
+        vehicleBlock.addField(fieldKey<"manufacturer">, manufacturerName);
+        vehicleBlock.addField(fieldKey<"weight">, vehicleWeight);
+        vehicleBlock.addField(fieldKey<"power">, enginePower);
+        vehicleBlock.addField(fieldKey<"year">, productionYear);
+
+        auto specificBlock = vehicleBlock.addBlock(fieldKey<"airplaneSpecific">);
+        specificBlock.addField(fieldKey<"wingspan">, wingSpan);
+        specificBlock.addField(fieldKey<"maxAltitude">, maxAltitude);
+        specificBlock.addField(fieldKey<"passengerCapacity">, maxPassengerCapacity);
+        specificBlock.addField(fieldKey<"maxSpeed">, maxSpeed);
+        specificBlock.endBlock();
+
+        vehicleBlock.endBlock();
+    }
+};
+
+class Ship final : public Vehicle {
+public:
+    double shipLength;
+    double shipDisplacement;
+    int crewCapacity;
+    InternedString propulsionType;
+
+    Ship() = default;
+
+    explicit Ship(const allocator_type& allocator)
+        : Vehicle(allocator) {
+    }
+
+    Ship(const Ship& other, const allocator_type& allocator)
+        : Vehicle(other, allocator), shipLength(other.shipLength), shipDisplacement(other.shipDisplacement),
+        crewCapacity(other.crewCapacity), propulsionType(other.propulsionType) {
+    }
+
+    Ship(Ship&& other, const allocator_type& allocator)
+        : Vehicle(std::move(other), allocator), shipLength(other.shipLength), shipDisplacement(other.shipDisplacement),
+        crewCapacity(other.crewCapacity), propulsionType(other.propulsionType) {
+    }
+
+    Ship(const Ship&) = default;
+    Ship(Ship&&) = default;
+    Ship& operator=(const Ship&) = default;
+    Ship& operator=(Ship&&) = default;
+
+    void serialize(Serializer& serializer) const override {
+        using namespace std::string_view_literals;
+
+        serializer.addBlock("vehicle"sv);
+        serializer.addField("type"sv, "Ship"sv);
+        serializer.addField("name"sv, modelName);
+        serializer.addField("manufacturer"sv, manufacturerName);
+        serializer.addField("weight"sv, vehicleWeight);
+        serializer.addField("power"sv, enginePower);
+        serializer.addField("year"sv, productionYear);
+
+        serializer.addBlock("shipSpecific"sv);
+        serializer.addField("length"sv, shipLength);
+        serializer.addField("displacement"sv, shipDisplacement);
+        serializer.addField("crewCapacity"sv, crewCapacity);
+        serializer.addField("propulsionType"sv, propulsionType);
+        serializer.endBlock();
+
+        serializer.endBlock();
+    }
+
+    void deserialize(Deserializer& deserializer) override {
+        using namespace std::string_view_literals;
+
+        deserializer.readField("name"sv, modelName);
+        deserializer.readField("manufacturer"sv, manufacturerName);
+        deserializer.readField("weight"sv, vehicleWeight);
+        deserializer.readField("power"sv, enginePower);
+        deserializer.readField("year"sv, productionYear);
+
+        deserializer.enterBlock("shipSpecific"sv);
+        deserializer.readField("length"sv, shipLength);
+        deserializer.readField("displacement"sv, shipDisplacement);
+        deserializer.readField("crewCapacity"sv, crewCapacity);
+        deserializer.readField("propulsionType"sv, propulsionType);
+        deserializer.exitBlock();
+    }
+
+    template<class BlockWriter>
+    void serializeTo(BlockWriter& blockWriter) const {
+        using namespace std::string_view_literals;
+
+        auto vehicleBlock = blockWriter.addBlock(fieldKey<"vehicle">);
+        vehicleBlock.addField(fieldKey<"type">, "Ship"sv);
+        vehicleBlock.addField(fieldKey<"name">, modelName);
+        vehicleBlock.addField(fieldKey<"manufacturer">, manufacturerName);
+        vehicleBlock.addField(fieldKey<"weight">, vehicleWeight);
+        vehicleBlock.addField(fieldKey<"power">, enginePower);
+        vehicleBlock.addField(fieldKey<"year">, productionYear);
+
+        auto specificBlock = vehicleBlock.addBlock(fieldKey<"shipSpecific">);
+        specificBlock.addField(fieldKey<"length">, shipLength);
+        specificBlock.addField(fieldKey<"displacement">, shipDisplacement);
+        specificBlock.addField(fieldKey<"crewCapacity">, crewCapacity);
+        specificBlock.addField(fieldKey<"propulsionType">, propulsionType);
+        specificBlock.endBlock();
+
+        vehicleBlock.endBlock();
+    }
+};
+
+inline void serializeVehicle(const Vehicle& vehicle, Serializer& serializer) {
+    vehicle.serialize(serializer);
+}
+
+inline void serializeVehicles(std::span<const Vehicle* const> vehicleList, Serializer& serializer) {
+    using namespace std::string_view_literals;
+
+    serializer.addArray("vehicles"sv);
+    for (std::size_t vehicleIndex = 0; vehicleIndex < vehicleList.size(); vehicleIndex++) {
+        std::size_t sizeBeforeVehicle = serializer.size();
+        vehicleList[vehicleIndex]->serialize(serializer);
+        if (vehicleIndex == 0 && serializer.size() > sizeBeforeVehicle) {
+            reserveForRemainingElements(serializer, serializer.size() - sizeBeforeVehicle, vehicleList.size() - 1);
+        }
+    }
+    serializer.endArray();
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Deserializer.h"
+#include "Serializer.h"
+#include "StringInternTable.h"
+#include "Vehicle.h"
+
+// Refers to one vehicle in a VehicleCollection. It stays valid while other
+// vehicles are inserted or removed and goes stale once its own vehicle is removed.
+struct VehicleHandle {
+    VehicleKind vehicleKind;
+    std::uint32_t slotId;
+    std::uint32_t slotGeneration;
+};
+
+// Contiguous storage for one concrete vehicle type. Vehicles are kept densely
+// packed and removed by moving the last one into the hole; the slot tables map
+// stable slot ids to dense positions and back. Vehicles and slot tables are
+// allocated from the segment's memory resource.
+template<class VehicleType>
+class VehicleSegment {
+private:
+    static constexpr std::uint32_t freeSlotMarker = UINT32_MAX;
+
+    std::pmr::vector<VehicleType> vehicles;
+    std::pmr::vector<std::uint32_t> slotIdsByPosition;
+    std::pmr::vector<std::uint32_t> positionsBySlot;
+    std::pmr::vector<std::uint32_t> generationsBySlot;
+    std::pmr::vector<std::uint32_t> freeSlotIds;
+
+    std::uint32_t findPosition(std::uint32_t slotId, std::uint32_t slotGeneration) const {
+        if (slotId >= positionsBySlot.size() || generationsBySlot[slotId] != slotGeneration || positionsBySlot[slotId] == freeSlotMarker) {
+            throw std::out_of_range("Stale or invalid vehicle handle");
+        }
+        return positionsBySlot[slotId];
+    }
+
+public:
+    explicit VehicleSegment(std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+        : vehicles(memoryResource), slotIdsByPosition(memoryResource), positionsBySlot(memoryResource),
+        generationsBySlot(memoryResource), freeSlotIds(memoryResource) {
+    }
+
+    std::pair<std::uint32_t, std::uint32_t> insert(VehicleType&& vehicle) {
+        std::uint32_t slotId;
+        if (freeSlotIds.empty()) {
+            slotId = static_cast<std::uint32_t>(positionsBySlot.size());
+            positionsBySlot.push_back(0);
+            generationsBySlot.push_back(0);
+        }
+        else {
+            slotId = freeSlotIds.back();
+            freeSlotIds.pop_back();
+        }
+        positionsBySlot[slotId] = static_cast<std::uint32_t>(vehicles.size());
+        vehicles.push_back(std::move(vehicle));
+        slotIdsByPosition.push_back(slotId);
+        return { slotId, generationsBySlot[slotId] };
+    }
+
+    void remove(std::uint32_t slotId, std::uint32_t slotGeneration) {
+        std::uint32_t removedPosition = findPosition(slotId, slotGeneration);
+        std::uint32_t lastPosition = static_cast<std::uint32_t>(vehicles.size() - 1);
+        if (removedPosition != lastPosition) {
+            vehicles[removedPosition] = std::move(vehicles[lastPosition]);
+            std::uint32_t movedSlotId = slotIdsByPosition[lastPosition];
+            slotIdsByPosition[removedPosition] = movedSlotId;
+            positionsBySlot[movedSlotId] = removedPosition;
+        }
+        vehicles.pop_back();
+        slotIdsByPosition.pop_back();
+        positionsBySlot[slotId] = freeSlotMarker;
+        generationsBySlot[slotId]++;
+        freeSlotIds.push_back(slotId);
+    }
+
+    VehicleType& at(std::uint32_t slotId, std::uint32_t slotGeneration) {
+        return vehicles[findPosition(slotId, slotGeneration)];
+    }
+
+    const VehicleType& at(std::uint32_t slotId, std::uint32_t slotGeneration) const {
+        return vehicles[findPosition(slotId, slotGeneration)];
+    }
+
+    bool contains(std::uint32_t slotId, std::uint32_t slotGeneration) const {
+        return slotId < positionsBySlot.size() && generationsBySlot[slotId] == slotGeneration && positionsBySlot[slotId] != freeSlotMarker;
+    }
+
+    std::span<VehicleType> view() {
+        return vehicles;
+    }
+
+    std::span<const VehicleType> view() const {
+        return vehicles;
+    }
+
+    std::size_t size() const {
+        return vehicles.size();
+    }
+
+    void reserve(std::size_t vehicleCount) {
+        vehicles.reserve(vehicleCount);
+        slotIdsByPosition.reserve(vehicleCount);
+    }
+
+    void clear() {
+        vehicles.clear();
+        slotIdsByPosition.clear();
+        positionsBySlot.clear();
+        generationsBySlot.clear();
+        freeSlotIds.clear();
+    }
+};
+
+// Stores cars, airplanes and ships by value in one segment per type. Iteration
+// walks the segments one after another, so each loop sees a single concrete type:
+// since the vehicle classes are final, serialize() on them is a direct call.
+// Vehicles read by deserializeVehicleCollection() intern their strings into the
+// collection's own table, which goes away with the collection instead of growing the
+// global one; the collection is therefore neither copied nor moved.
+class VehicleCollection {
+private:
+    std::pmr::memory_resource* memoryResource;
+    StringInternTable collectionInternTable;
+    VehicleSegment<Car> carSegment;
+    VehicleSegment<Airplane> airplaneSegment;
+    VehicleSegment<Ship> shipSegment;
+
+    static VehicleHandle makeHandle(VehicleKind vehicleKind, std::pair<std::uint32_t, std::uint32_t> slot) {
+        return { vehicleKind, slot.first, slot.second };
+    }
+
+public:
+    // Inserted vehicles are copied into the collection's resource unless they were
+    // already built with it.
+    explicit VehicleCollection(std::pmr::memory_resource* collectionResource = std::pmr::get_default_resource())
+        : memoryResource(collectionResource), carSegment(collectionResource), airplaneSegment(collectionResource), shipSegment(collectionResource) {
+    }
+
+    std::pmr::memory_resource* resource() const {
+        return memoryResource;
+    }
+
+    StringInternTable& internTable() {
+        return collectionInternTable;
+    }
+
+    VehicleHandle insert(Car car) {
+        return makeHandle(VehicleKind::Car, carSegment.insert(std::move(car)));
+    }
+
+    VehicleHandle insert(Airplane airplane) {
+        return makeHandle(VehicleKind::Airplane, airplaneSegment.insert(std::move(airplane)));
+    }
+
+    VehicleHandle insert(Ship ship) {
+        return makeHandle(VehicleKind::Ship, shipSegment.insert(std::move(ship)));
+    }
+
+    void remove(VehicleHandle vehicleHandle) {
+        switch (vehicleHandle.vehicleKind) {
+        case VehicleKind::Car:
+            carSegment.remove(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+            break;
+        case VehicleKind::Airplane:
+            airplaneSegment.remove(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+            break;
+        case VehicleKind::Ship:
+            shipSegment.remove(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+            break;
+        }
+    }
+
+    Vehicle& at(VehicleHandle vehicleHandle) {
+        switch (vehicleHandle.vehicleKind) {
+        case VehicleKind::Car:
+            return carSegment.at(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+        case VehicleKind::Airplane:
+            return airplaneSegment.at(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+        default:
+            return shipSegment.at(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+        }
+    }
+
+    bool contains(VehicleHandle vehicleHandle) const {
+        switch (vehicleHandle.vehicleKind) {
+        case VehicleKind::Car:
+            return carSegment.contains(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+        case VehicleKind::Airplane:
+            return airplaneSegment.contains(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+        default:
+            return shipSegment.contains(vehicleHandle.slotId, vehicleHandle.slotGeneration);
+        }
+    }
+
+    std::span<const Car> cars() const {
+        return carSegment.view();
+    }
+
+    std::span<const Airplane> airplanes() const {
+        return airplaneSegment.view();
+    }
+
+    std::span<const Ship> ships() const {
+        return shipSegment.view();
+    }
+
+    // Calls the visitor with every vehicle as its concrete type, segment by segment.
+    template<class Visitor>
+    void forEach(Visitor&& visitor) const {
+        for (const Car& car : carSegment.view()) {
+            visitor(car);
+        }
+        for (const Airplane& airplane : airplaneSegment.view()) {
+            visitor(airplane);
+        }
+        for (const Ship& ship : shipSegment.view()) {
+            visitor(ship);
+        }
+    }
+
+    std::size_t size() const {
+        return carSegment.size() + airplaneSegment.size() + shipSegment.size();
+    }
+
+    void clear() {
+        carSegment.clear();
+        airplaneSegment.clear();
+        shipSegment.clear();
+    }
+};
+
+// Writes the same "vehicles" array as serializeVehicles(), grouped by type: all
+// cars first, then airplanes, then ships, each group in segment order.
+inline void serializeVehicleCollection(const VehicleCollection& vehicleCollection, Serializer& serializer) {
+    using namespace std::string_view_literals;
+
+    serializer.addArray("vehicles"sv);
+    bool isReserved = false;
+    vehicleCollection.forEach([&](const auto& vehicle) {
+        std::size_t sizeBeforeVehicle = serializer.size();
+        vehicle.serialize(serializer);
+        if (!isReserved && serializer.size() > sizeBeforeVehicle) {
+            reserveForRemainingElements(serializer, serializer.size() - sizeBeforeVehicle, vehicleCollection.size() - 1);
+            isReserved = true;
+        }
+    });
+    serializer.endArray();
+}
+
+// Reads a "vehicles" array straight into the collection. Each vehicle is built with
+// the collection's resource, so with an arena no string is allocated twice, and the
+// deserializer is switched to the collection's intern table.
+inline void deserializeVehicleCollection(Deserializer& deserializer, VehicleCollection& vehicleCollection) {
+    using namespace std::string_view_literals;
+
+    Vehicle::allocator_type vehicleAllocator(vehicleCollection.resource());
+    deserializer.setInternTable(vehicleCollection.internTable());
+    deserializer.enterArray("vehicles"sv);
+    while (deserializer.hasNextElement()) {
+        deserializer.enterBlock("vehicle"sv);
+        std::string_view vehicleType = deserializer.readText("type"sv);
+        if (vehicleType == "Car") {
+            Car car(vehicleAllocator);
+            car.deserialize(deserializer);
+            vehicleCollection.insert(std::move(car));
+        }
+        else if (vehicleType == "Airplane") {
+            Airplane airplane(vehicleAllocator);
+            airplane.deserialize(deserializer);
+            vehicleCollection.insert(std::move(airplane));
+        }
+        else if (vehicleType == "Ship") {
+            Ship ship(vehicleAllocator);
+            ship.deserialize(deserializer);
+            vehicleCollection.insert(std::move(ship));
+        }
+        else {
+            throw std::invalid_argument("Unsupported vehicle type: " + std::string(vehicleType));
+        }
+        deserializer.exitBlock();
+    }
+    deserializer.exitArray();
+}
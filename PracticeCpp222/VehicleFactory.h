@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Deserializer.h"
+#include "StringInternTable.h"
+#include "Vehicle.h"
+
+inline std::unique_ptr<Vehicle> createVehicle(std::string_view vehicleType) {
+    if (vehicleType == "Car") {
+        return std::make_unique<Car>();
+    }
+    else if (vehicleType == "Airplane") {
+        return std::make_unique<Airplane>();
+    }
+    else if (vehicleType == "Ship") {
+        return std::make_unique<Ship>();
+    }
+    throw std::invalid_argument("Unsupported vehicle type: " + std::string(vehicleType));
+}
+
+// The "type" field must be the first field of the vehicle block, as serialize() writes it.
+inline std::unique_ptr<Vehicle> deserializeVehicle(Deserializer& deserializer) {
+    using namespace std::string_view_literals;
+
+    deserializer.enterBlock("vehicle"sv);
+    std::unique_ptr<Vehicle> vehicle = createVehicle(deserializer.readText("type"sv));
+    vehicle->deserialize(deserializer);
+    deserializer.exitBlock();
+    return vehicle;
+}
+
+// The vehicles intern their strings into internTable, which must outlive them.
+inline std::vector<std::unique_ptr<Vehicle>> deserializeVehicles(Deserializer& deserializer, StringInternTable& internTable) {
+    using namespace std::string_view_literals;
+
+    deserializer.setInternTable(internTable);
+    std::vector<std::unique_ptr<Vehicle>> vehicleList;
+    deserializer.enterArray("vehicles"sv);
+    while (deserializer.hasNextElement()) {
+        vehicleList.push_back(deserializeVehicle(deserializer));
+    }
+    deserializer.exitArray();
+    return vehicleList;
+}
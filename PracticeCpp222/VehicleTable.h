@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "Serializer.h"
+#include "StringDictionary.h"
+#include "Vehicle.h"
+
+// Column store for vehicles. The fields every vehicle has live in one column per
+// field, indexed by row; the fields of each concrete type live in that type's own
+// columns, indexed by the row's specificRows entry. Strings are dictionary-encoded
+// into a shared StringDictionary, so a column of names is a column of 32-bit ids.
+class VehicleTable {
+private:
+    StringDictionary stringDictionary;
+
+    std::vector<VehicleKind> vehicleKinds;
+    std::vector<std::uint32_t> specificRows;
+    std::vector<std::uint32_t> modelNameIds;
+    std::vector<std::uint32_t> manufacturerNameIds;
+    std::vector<double> vehicleWeights;
+    std::vector<double> enginePowers;
+    std::vector<int> productionYears;
+
+    std::vector<int> carDoorCounts;
+    std::vector<int> carPassengerSeatCounts;
+    std::vector<std::uint32_t> carFuelTypeIds;
+    std::vector<double> carEngineVolumes;
+
+    std::vector<int> airplaneWingSpans;
+    std::vector<int> airplaneMaxAltitudes;
+    std::vector<int> airplaneMaxPassengerCapacities;
+    std::vector<double> airplaneMaxSpeeds;
+
+    std::vector<double> shipLengths;
+    std::vector<double> shipDisplacements;
+    std::vector<int> shipCrewCapacities;
+    std::vector<std::uint32_t> shipPropulsionTypeIds;
+
+    void appendCommonFields(const Vehicle& vehicle, VehicleKind vehicleKind, std::size_t specificRow) {
+        vehicleKinds.push_back(vehicleKind);
+        specificRows.push_back(static_cast<std::uint32_t>(specificRow));
+        modelNameIds.push_back(stringDictionary.intern(vehicle.modelName));
+        manufacturerNameIds.push_back(stringDictionary.intern(vehicle.manufacturerName));
+        vehicleWeights.push_back(vehicle.vehicleWeight);
+        enginePowers.push_back(vehicle.enginePower);
+        productionYears.push_back(vehicle.productionYear);
+    }
+
+    void serializeCommonFields(std::size_t rowIndex, std::string_view typeName, Serializer& serializer) const {
+        using namespace std::string_view_literals;
+
+        serializer.addField("type"sv, typeName);
+        serializer.addField("name"sv, stringDictionary.text(modelNameIds[rowIndex]));
+        serializer.addField("manufacturer"sv, stringDictionary.text(manufacturerNameIds[rowIndex]));
+        serializer.addField("weight"sv, vehicleWeights[rowIndex]);
+        serializer.addField("power"sv, enginePowers[rowIndex]);
+        serializer.addField("year"sv, productionYears[rowIndex]);
+    }
+
+public:
+    void append(const Car& car) {
+        appendCommonFields(car, VehicleKind::Car, carDoorCounts.size());
+        carDoorCounts.push_back(car.doorCount);
+        carPassengerSeatCounts.push_back(car.passengerSeatCount);
+        carFuelTypeIds.push_back(stringDictionary.intern(car.fuelType));
+        carEngineVolumes.push_back(car.engineVolume);
+    }
+
+    void append(const Airplane& airplane) {
+        appendCommonFields(airplane, VehicleKind::Airplane, airplaneWingSpans.size());
+        airplaneWingSpans.push_back(airplane.wingSpan);
+        airplaneMaxAltitudes.push_back(airplane.maxAltitude);
+        airplaneMaxPassengerCapacities.push_back(airplane.maxPassengerCapacity);
+        airplaneMaxSpeeds.push_back(airplane.maxSpeed);
+    }
+
+    void append(const Ship& ship) {
+        appendCommonFields(ship, VehicleKind::Ship, shipLengths.size());
+        shipLengths.push_back(ship.shipLength);
+        shipDisplacements.push_back(ship.shipDisplacement);
+        shipCrewCapacities.push_back(ship.crewCapacity);
+        shipPropulsionTypeIds.push_back(stringDictionary.intern(ship.propulsionType));
+    }
+
+    void append(const Vehicle& vehicle) {
+        if (const Car* car = dynamic_cast<const Car*>(&vehicle)) {
+            append(*car);
+        }
+        else if (const Airplane* airplane = dynamic_cast<const Airplane*>(&vehicle)) {
+            append(*airplane);
+        }
+        else if (const Ship* ship = dynamic_cast<const Ship*>(&vehicle)) {
+            append(*ship);
+        }
+        else {
+            throw std::invalid_argument("Unsupported vehicle type for VehicleTable");
+        }
+    }
+
+    void appendAll(std::span<const Vehicle* const> vehicleList) {
+        reserve(size() + vehicleList.size());
+        for (const Vehicle* vehicle : vehicleList) {
+            append(*vehicle);
+        }
+    }
+
+    // Reserves the common columns only; the split between types is not known upfront.
+    void reserve(std::size_t rowCount) {
+        vehicleKinds.reserve(rowCount);
+        specificRows.reserve(rowCount);
+        modelNameIds.reserve(rowCount);
+        manufacturerNameIds.reserve(rowCount);
+        vehicleWeights.reserve(rowCount);
+        enginePowers.reserve(rowCount);
+        productionYears.reserve(rowCount);
+    }
+
+    std::size_t size() const {
+        return vehicleKinds.size();
+    }
+
+    const StringDictionary& strings() const {
+        return stringDictionary;
+    }
+
+    std::span<const VehicleKind> kinds() const {
+        return vehicleKinds;
+    }
+
+    std::span<const std::uint32_t> modelNames() const {
+        return modelNameIds;
+    }
+
+    std::span<const std::uint32_t> manufacturerNames() const {
+        return manufacturerNameIds;
+    }
+
+    std::span<const double> weights() const {
+        return vehicleWeights;
+    }
+
+    std::span<const double> powers() const {
+        return enginePowers;
+    }
+
+    std::span<const int> years() const {
+        return productionYears;
+    }
+
+    // Writes the row exactly as the matching Vehicle::serialize() would.
+    void serializeRow(std::size_t rowIndex, Serializer& serializer) const {
+        using namespace std::string_view_literals;
+
+        std::size_t specificRow = specificRows[rowIndex];
+        serializer.addBlock("vehicle"sv);
+        switch (vehicleKinds[rowIndex]) {
+        case VehicleKind::Car:
+            serializeCommonFields(rowIndex, "Car"sv, serializer);
+            serializer.addBlock("carSpecific"sv);
+            serializer.addField("doors"sv, carDoorCounts[specificRow]);
+            serializer.addField("passengerSeats"sv, carPassengerSeatCounts[specificRow]);
+            serializer.addField("fuelType"sv, stringDictionary.text(carFuelTypeIds[specificRow]));
+            serializer.addField("engineVolume"sv, carEngineVolumes[specificRow]);
+            serializer.endBlock();
+            break;
+        case VehicleKind::Airplane:
+            serializeCommonFields(rowIndex, "Airplane"sv, serializer);
+            serializer.addBlock("airplaneSpecific"sv);
+            serializer.addField("wingspan"sv, airplaneWingSpans[specificRow]);
+            serializer.addField("maxAltitude"sv, airplaneMaxAltitudes[specificRow]);
+            serializer.addField("passengerCapacity"sv, airplaneMaxPassengerCapacities[specificRow]);
+            serializer.addField("maxSpeed"sv, airplaneMaxSpeeds[specificRow]);
+            serializer.endBlock();
+            break;
+        case VehicleKind::Ship:
+            serializeCommonFields(rowIndex, "Ship"sv, serializer);
+            serializer.addBlock("shipSpecific"sv);
+            serializer.addField("length"sv, shipLengths[specificRow]);
+            serializer.addField("displacement"sv, shipDisplacements[specificRow]);
+            serializer.addField("crewCapacity"sv, shipCrewCapacities[specificRow]);
+            serializer.addField("propulsionType"sv, stringDictionary.text(shipPropulsionTypeIds[specificRow]));
+            serializer.endBlock();
+            break;
+        }
+        serializer.endBlock();
+    }
+
+    void clear() {
+        *this = VehicleTable();
+    }
+};
+
+// Same document as serializeVehicles() over the vehicles the table was built from.
+inline void serializeVehicleTable(const VehicleTable& vehicleTable, Serializer& serializer) {
+    using namespace std::string_view_literals;
+
+    serializer.addArray("vehicles"sv);
+    for (std::size_t rowIndex = 0; rowIndex < vehicleTable.size(); rowIndex++) {
+        std::size_t sizeBeforeRow = serializer.size();
+        vehicleTable.serializeRow(rowIndex, serializer);
+        if (rowIndex == 0 && serializer.size() > sizeBeforeRow) {
+            reserveForRemainingElements(serializer, serializer.size() - sizeBeforeRow, vehicleTable.size() - 1);
+        }
+    }
+    serializer.endArray();
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Every worker owns a task deque. A worker pops its own tasks from the back (newest
+// first, so recently submitted work is still warm in cache) and, once its deque is
+// empty, steals the oldest task from the front of another worker's deque.
+class WorkStealingExecutor {
+public:
+    using Task = std::function<void(std::size_t workerIndex)>;
+
+private:
+    struct WorkerQueue {
+        std::mutex queueMutex;
+        std::deque<Task> pendingTasks;
+    };
+
+    static inline thread_local const WorkStealingExecutor* currentExecutor = nullptr;
+    static inline thread_local std::size_t currentWorkerIndex = 0;
+
+    std::vector<std::unique_ptr<WorkerQueue>> workerQueues;
+    std::vector<std::thread> workerThreads;
+    std::atomic<std::size_t> queuedTaskCount{ 0 };
+    std::atomic<std::size_t> nextSubmitQueue{ 0 };
+
+    std::mutex stateMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allTasksDone;
+    std::size_t unfinishedTaskCount = 0;
+    std::exception_ptr firstTaskError;
+    bool isStopping = false;
+
+    std::optional<Task> popOwnTask(std::size_t workerIndex) {
+        WorkerQueue& ownQueue = *workerQueues[workerIndex];
+        std::lock_guard<std::mutex> queueLock(ownQueue.queueMutex);
+        if (ownQueue.pendingTasks.empty()) {
+            return std::nullopt;
+        }
+        Task nextTask = std::move(ownQueue.pendingTasks.back());
+        ownQueue.pendingTasks.pop_back();
+        queuedTaskCount.fetch_sub(1, std::memory_order_relaxed);
+        return nextTask;
+    }
+
+    std::optional<Task> stealTask(std::size_t thiefIndex) {
+        for (std::size_t offset = 1; offset < workerQueues.size(); offset++) {
+            WorkerQueue& victimQueue = *workerQueues[(thiefIndex + offset) % workerQueues.size()];
+            std::lock_guard<std::mutex> queueLock(victimQueue.queueMutex);
+            if (victimQueue.pendingTasks.empty()) {
+                continue;
+            }
+            Task stolenTask = std::move(victimQueue.pendingTasks.front());
+            victimQueue.pendingTasks.pop_front();
+            queuedTaskCount.fetch_sub(1, std::memory_order_relaxed);
+            return stolenTask;
+        }
+        return std::nullopt;
+    }
+
+    void runWorker(std::size_t workerIndex) {
+        currentExecutor = this;
+        currentWorkerIndex = workerIndex;
+        while (true) {
+            std::optional<Task> nextTask = popOwnTask(workerIndex);
+            if (!nextTask) {
+                nextTask = stealTask(workerIndex);
+            }
+            if (!nextTask) {
+                std::unique_lock<std::mutex> stateLock(stateMutex);
+                taskAvailable.wait(stateLock, [this] { return isStopping || queuedTaskCount.load(std::memory_order_relaxed) != 0; });
+                if (isStopping && queuedTaskCount.load(std::memory_order_relaxed) == 0) {
+                    return;
+                }
+                continue;
+            }
+
+            std::exception_ptr taskError;
+            try {
+                (*nextTask)(workerIndex);
+            }
+            catch (...) {
+                taskError = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> stateLock(stateMutex);
+            if (taskError && !firstTaskError) {
+                firstTaskError = std::move(taskError);
+            }
+            if (--unfinishedTaskCount == 0) {
+                allTasksDone.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit WorkStealingExecutor(std::size_t threadCount) {
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+        workerQueues.reserve(threadCount);
+        for (std::size_t workerIndex = 0; workerIndex < threadCount; workerIndex++) {
+            workerQueues.push_back(std::make_unique<WorkerQueue>());
+        }
+        workerThreads.reserve(threadCount);
+        for (std::size_t workerIndex = 0; workerIndex < threadCount; workerIndex++) {
+            workerThreads.emplace_back([this, workerIndex] { runWorker(workerIndex); });
+        }
+    }
+
+    ~WorkStealingExecutor() {
+        {
+            std::lock_guard<std::mutex> stateLock(stateMutex);
+            isStopping = true;
+        }
+        taskAvailable.notify_all();
+        for (std::thread& workerThread : workerThreads) {
+            workerThread.join();
+        }
+    }
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    std::size_t size() const {
+        return workerThreads.size();
+    }
+
+    // Pushes onto the back of the given worker's deque.
+    void submitTo(std::size_t workerIndex, Task task) {
+        {
+            std::lock_guard<std::mutex> stateLock(stateMutex);
+            unfinishedTaskCount++;
+            WorkerQueue& targetQueue = *workerQueues[workerIndex % workerQueues.size()];
+            std::lock_guard<std::mutex> queueLock(targetQueue.queueMutex);
+            targetQueue.pendingTasks.push_back(std::move(task));
+            queuedTaskCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        taskAvailable.notify_one();
+    }
+
+    // Called from a worker, keeps the task on that worker's own deque; called from
+    // outside, spreads tasks over the workers round-robin.
+    void submit(Task task) {
+        std::size_t workerIndex = currentExecutor == this
+            ? currentWorkerIndex
+            : nextSubmitQueue.fetch_add(1, std::memory_order_relaxed);
+        submitTo(workerIndex, std::move(task));
+    }
+
+    // Blocks until every submitted task has run and rethrows the first task failure.
+    // Must not be called from one of this executor's workers.
+    void waitIdle() {
+        std::unique_lock<std::mutex> stateLock(stateMutex);
+        allTasksDone.wait(stateLock, [this] { return unfinishedTaskCount == 0; });
+        if (firstTaskError) {
+            std::exception_ptr taskError = std::exchange(firstTaskError, nullptr);
+            std::rethrow_exception(taskError);
+        }
+    }
+};
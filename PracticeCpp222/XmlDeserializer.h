@@ -0,0 +1,187 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "Deserializer.h"
+#include "XmlEscapes.h"
+
+// Reads the element-per-field documents XmlSerializer writes, pretty or compact,
+// directly from the caller's buffer. Nothing is copied: tag names are compared in
+// place, text is returned as views into the buffer, and entity references are
+// decoded by rewriting the text where it lies, which is why the buffer must be
+// mutable. A private copy-on-write file mapping works as well as a plain string.
+class XmlDeserializer : public Deserializer {
+private:
+    struct OpenElement {
+        std::string_view elementName;
+        bool isArray;
+    };
+
+    char* documentEnd = nullptr;
+    char* readPosition = nullptr;
+    std::pmr::vector<OpenElement> openElements;
+
+    static bool isWhitespace(char character) {
+        return character == ' ' || character == '\n' || character == '\r' || character == '\t';
+    }
+
+    bool isInsideArray() const {
+        return !openElements.empty() && openElements.back().isArray;
+    }
+
+    void skipWhitespace() {
+        while (readPosition < documentEnd && isWhitespace(*readPosition)) {
+            readPosition++;
+        }
+    }
+
+    void skipProlog() {
+        skipWhitespace();
+        if (documentEnd - readPosition >= 2 && readPosition[0] == '<' && readPosition[1] == '?') {
+            std::string_view remainingText(readPosition, documentEnd - readPosition);
+            std::size_t prologEnd = remainingText.find("?>");
+            if (prologEnd == std::string_view::npos) {
+                throwMalformedXml("unterminated XML declaration");
+            }
+            readPosition += prologEnd + 2;
+        }
+    }
+
+    // Reads "<name>" and returns the name. Inside an array any element name is
+    // accepted; elsewhere it must equal the expected one.
+    std::string_view readOpeningTag(std::string_view expectedName) {
+        skipWhitespace();
+        if (readPosition >= documentEnd || *readPosition != '<') {
+            throwMalformedXml("expected an opening tag");
+        }
+        char* nameBegin = readPosition + 1;
+        char* nameEnd = static_cast<char*>(std::memchr(nameBegin, '>', documentEnd - nameBegin));
+        if (nameEnd == nullptr) {
+            throwMalformedXml("unterminated tag");
+        }
+        std::string_view elementName(nameBegin, nameEnd - nameBegin);
+        if (elementName.empty() || elementName[0] == '/') {
+            throwMalformedXml("expected an opening tag");
+        }
+        if (!isInsideArray() && elementName != expectedName) {
+            throwMalformedXml("unexpected element name");
+        }
+        readPosition = nameEnd + 1;
+        return elementName;
+    }
+
+    void readClosingTag(std::string_view elementName) {
+        std::size_t tagSize = elementName.size() + 3;
+        if (static_cast<std::size_t>(documentEnd - readPosition) < tagSize
+            || readPosition[0] != '<' || readPosition[1] != '/'
+            || std::memcmp(readPosition + 2, elementName.data(), elementName.size()) != 0
+            || readPosition[tagSize - 1] != '>') {
+            throwMalformedXml("mismatched closing tag");
+        }
+        readPosition += tagSize;
+    }
+
+    // Reads "<name>text</name>" and returns the decoded text.
+    std::string_view readElementText(std::string_view fieldName) {
+        std::string_view elementName = readOpeningTag(fieldName);
+        char* textBegin = readPosition;
+        char* textEnd = static_cast<char*>(std::memchr(textBegin, '<', documentEnd - textBegin));
+        if (textEnd == nullptr) {
+            throwMalformedXml("unterminated element");
+        }
+        readPosition = textEnd;
+        readClosingTag(elementName);
+        char* decodedEnd = decodeXmlEntitiesInPlace(textBegin, textEnd);
+        return std::string_view(textBegin, decodedEnd - textBegin);
+    }
+
+    template<class NumberType>
+    void readNumberElement(std::string_view fieldName, NumberType& fieldValue) {
+        std::string_view numberText = readElementText(fieldName);
+        auto [numberEnd, errorCode] = std::from_chars(numberText.data(), numberText.data() + numberText.size(), fieldValue);
+        if (errorCode != std::errc() || numberEnd != numberText.data() + numberText.size()) {
+            throwMalformedXml("invalid number");
+        }
+    }
+
+    void openElement(std::string_view elementName, bool isArray) {
+        openElements.push_back({ readOpeningTag(elementName), isArray });
+    }
+
+    void closeElement() {
+        if (openElements.empty()) {
+            throwMalformedXml("no open element");
+        }
+        skipWhitespace();
+        readClosingTag(openElements.back().elementName);
+        openElements.pop_back();
+    }
+
+public:
+    using Deserializer::readField;
+
+    explicit XmlDeserializer(std::span<char> xmlBuffer, std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+        : openElements(memoryResource) {
+        reset(xmlBuffer);
+    }
+
+    std::string_view readText(std::string_view fieldName) override {
+        return readElementText(fieldName);
+    }
+
+    void readField(std::string_view fieldName, int& fieldValue) override {
+        readNumberElement(fieldName, fieldValue);
+    }
+
+    void readField(std::string_view fieldName, double& fieldValue) override {
+        readNumberElement(fieldName, fieldValue);
+    }
+
+    void enterBlock(std::string_view blockName) override {
+        openElement(blockName, false);
+    }
+
+    void exitBlock() override {
+        closeElement();
+    }
+
+    void enterArray(std::string_view arrayName) override {
+        openElement(arrayName, true);
+    }
+
+    bool hasNextElement() override {
+        skipWhitespace();
+        if (documentEnd - readPosition < 2) {
+            throwMalformedXml("unexpected end of input");
+        }
+        return !(readPosition[0] == '<' && readPosition[1] == '/');
+    }
+
+    void exitArray() override {
+        closeElement();
+    }
+
+    void finish() override {
+        if (!openElements.empty()) {
+            throwMalformedXml("unclosed element");
+        }
+        skipWhitespace();
+        if (readPosition != documentEnd) {
+            throwMalformedXml("trailing content after document");
+        }
+    }
+
+    void reset(std::span<char> xmlBuffer) {
+        readPosition = xmlBuffer.data();
+        documentEnd = xmlBuffer.data() + xmlBuffer.size();
+        openElements.clear();
+        skipProlog();
+    }
+};
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "CpuFeatures.h"
+#include "EscapeScan.h"
+#include "Utf8.h"
+
+[[noreturn]] inline void throwMalformedXml(const char* reason) {
+    throw std::runtime_error(std::string("Malformed XML: ") + reason);
+}
+
+// Replaces the predefined entities and numeric character references in
+// [textBegin, textEnd) with the characters they stand for. Every replacement is
+// shorter than the reference it replaces, so the text is rewritten in place and
+// the new end is returned.
+inline char* decodeXmlEntitiesInPlace(char* textBegin, char* textEnd) {
+    char* readPosition = static_cast<char*>(std::memchr(textBegin, '&', textEnd - textBegin));
+    if (readPosition == nullptr) {
+        return textEnd;
+    }
+    char* writePosition = readPosition;
+    while (readPosition < textEnd) {
+        if (*readPosition != '&') {
+            *writePosition++ = *readPosition++;
+            continue;
+        }
+        char* referenceEnd = static_cast<char*>(std::memchr(readPosition, ';', textEnd - readPosition));
+        if (referenceEnd == nullptr) {
+            throwMalformedXml("unterminated entity reference");
+        }
+        std::string_view referenceName(readPosition + 1, referenceEnd - readPosition - 1);
+        if (referenceName == "lt") {
+            *writePosition++ = '<';
+        }
+        else if (referenceName == "gt") {
+            *writePosition++ = '>';
+        }
+        else if (referenceName == "amp") {
+            *writePosition++ = '&';
+        }
+        else if (referenceName == "quot") {
+            *writePosition++ = '"';
+        }
+        else if (referenceName == "apos") {
+            *writePosition++ = '\'';
+        }
+        else if (referenceName.size() > 1 && referenceName[0] == '#') {
+            bool isHexadecimal = referenceName[1] == 'x';
+            std::string_view digits = referenceName.substr(isHexadecimal ? 2 : 1);
+            std::uint32_t codePoint = 0;
+            auto [digitsEnd, errorCode] = std::from_chars(digits.data(), digits.data() + digits.size(), codePoint, isHexadecimal ? 16 : 10);
+            if (errorCode != std::errc() || digitsEnd != digits.data() + digits.size() || digits.empty() || codePoint > 0x10ffff) {
+                throwMalformedXml("invalid character reference");
+            }
+            writePosition += encodeUtf8(codePoint, writePosition);
+        }
+        else {
+            throwMalformedXml("unknown entity reference");
+        }
+        readPosition = referenceEnd + 1;
+    }
+    return writePosition;
+}
+
+// '&', '<' and '>' become entity references, which is enough for element content.
+// Tabs and newlines pass through and carriage returns become &#13; so that parsers
+// do not normalize them away. The other control characters cannot appear in an XML
+// 1.0 document at all, not even as references, and are replaced with U+FFFD. UTF-8
+// passes through unchanged.
+struct XmlEscapeTraits {
+    // The longest replacement is &amp; or &#13;, five bytes for one input byte.
+    static constexpr std::size_t maxExpansion = 5;
+
+    static constexpr auto escapeTable = [] {
+        std::array<bool, 256> isEscaped{};
+        for (int code = 0; code < 0x20; code++) {
+            isEscaped[code] = true;
+        }
+        isEscaped['&'] = true;
+        isEscaped['<'] = true;
+        isEscaped['>'] = true;
+        return isEscaped;
+    }();
+
+    static bool hasEscapeInWord(std::uint64_t word) {
+        return (markBytesEqual(word, '&') | markBytesEqual(word, '<') | markBytesEqual(word, '>') | markBytesBelow(word, 0x20)) != 0;
+    }
+
+#if PRACTICE_X86_SIMD
+    static __m128i escapeMaskSse2(__m128i chunk) {
+        __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8(0x1f)), chunk);
+        __m128i isAmpersand = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('&'));
+        __m128i isAngleBracket = _mm_cmpeq_epi8(_mm_or_si128(chunk, _mm_set1_epi8(0x02)), _mm_set1_epi8('>'));
+        return _mm_or_si128(_mm_or_si128(isAmpersand, isAngleBracket), isControl);
+    }
+
+    PRACTICE_TARGET_AVX2 static __m256i escapeMaskAvx2(__m256i chunk) {
+        __m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, _mm256_set1_epi8(0x1f)), chunk);
+        __m256i isAmpersand = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('&'));
+        __m256i isAngleBracket = _mm256_cmpeq_epi8(_mm256_or_si256(chunk, _mm256_set1_epi8(0x02)), _mm256_set1_epi8('>'));
+        return _mm256_or_si256(_mm256_or_si256(isAmpersand, isAngleBracket), isControl);
+    }
+#endif
+
+    static char* writeEscape(char character, char* target) {
+        std::string_view replacement;
+        switch (character) {
+        case '&':
+            replacement = "&amp;";
+            break;
+        case '<':
+            replacement = "&lt;";
+            break;
+        case '>':
+            replacement = "&gt;";
+            break;
+        case '\r':
+            replacement = "&#13;";
+            break;
+        case '\t':
+        case '\n':
+            *target++ = character;
+            return target;
+        default:
+            replacement = "\xef\xbf\xbd";
+            break;
+        }
+        std::memcpy(target, replacement.data(), replacement.size());
+        return target + replacement.size();
+    }
+};
+
+constexpr std::size_t maxXmlEscapeExpansion = XmlEscapeTraits::maxExpansion;
+
+// Writes text as escaped element content and returns the new end. target must have
+// room for text.size() * maxXmlEscapeExpansion bytes.
+inline char* encodeXmlEntities(std::string_view text, char* target, SimdLevel simdLevel) {
+    return encodeEscapes<XmlEscapeTraits>(text, target, simdLevel);
+}
+
+// Appends the escaped text to encodedText.
+inline void encodeXmlEntities(std::string_view text, std::string& encodedText) {
+    std::size_t previousSize = encodedText.size();
+    encodedText.resize(previousSize + text.size() * maxXmlEscapeExpansion);
+    char* encodedEnd = encodeXmlEntities(text, encodedText.data() + previousSize, limitSimdLevel(SimdLevel::Avx2));
+    encodedText.resize(encodedEnd - encodedText.data());
+}
+
+// Element names are written verbatim, so they are checked instead of escaped. This is
+// the ASCII subset of the XML Name production; every byte of a multi-byte UTF-8
+// sequence is accepted, which admits the non-ASCII name characters without decoding.
+inline constexpr auto xmlNameCharacterTable = [] {
+    std::array<bool, 256> isNameCharacter{};
+    for (int code = 0x80; code < 0x100; code++) {
+        isNameCharacter[code] = true;
+    }
+    for (char letter = 'a'; letter <= 'z'; letter++) {
+        isNameCharacter[static_cast<unsigned char>(letter)] = true;
+        isNameCharacter[static_cast<unsigned char>(letter - 'a' + 'A')] = true;
+    }
+    for (char digit = '0'; digit <= '9'; digit++) {
+        isNameCharacter[static_cast<unsigned char>(digit)] = true;
+    }
+    isNameCharacter['_'] = true;
+    isNameCharacter[':'] = true;
+    isNameCharacter['-'] = true;
+    isNameCharacter['.'] = true;
+    return isNameCharacter;
+}();
+
+// Marks the bytes in [lowest, highest]. The word must hold 7-bit values, so the
+// additions never carry into the next byte and, unlike markBytesEqual(), no byte is
+// flagged spuriously.
+inline std::uint64_t markAsciiBytesInRange(std::uint64_t asciiWord, unsigned char lowest, unsigned char highest) {
+    std::uint64_t atLeastLowest = asciiWord + swarLowBits * (0x80 - lowest);
+    std::uint64_t aboveHighest = asciiWord + swarLowBits * (0x7f - highest);
+    return atLeastLowest & ~aboveHighest & swarHighBits;
+}
+
+// The same test as the table, eight bytes at a time; XmlSerializer checks the name on
+// every addField() call.
+inline bool hasOnlyXmlNameBytes(std::uint64_t word) {
+    std::uint64_t asciiBytes = ~word & swarHighBits;
+    std::uint64_t asciiWord = word & ~swarHighBits;
+    std::uint64_t nameBytes = markAsciiBytesInRange(asciiWord | swarLowBits * 0x20, 'a', 'z')
+        | markAsciiBytesInRange(asciiWord, '0', ':')
+        | markAsciiBytesInRange(asciiWord, '-', '.')
+        | markAsciiBytesInRange(asciiWord, '_', '_');
+    return (asciiBytes & ~nameBytes) == 0;
+}
+
+constexpr bool isXmlName(std::string_view name) {
+    if (name.empty()) {
+        return false;
+    }
+    char firstCharacter = name.front();
+    if ((firstCharacter >= '0' && firstCharacter <= '9') || firstCharacter == '-' || firstCharacter == '.') {
+        return false;
+    }
+    if consteval {
+        for (char character : name) {
+            if (!xmlNameCharacterTable[static_cast<unsigned char>(character)]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    else {
+        if (name.size() < 4) {
+            return xmlNameCharacterTable[static_cast<unsigned char>(name.front())] && xmlNameCharacterTable[static_cast<unsigned char>(name[name.size() / 2])]
+                && xmlNameCharacterTable[static_cast<unsigned char>(name.back())];
+        }
+        if (name.size() < 8) {
+            std::uint32_t headHalf;
+            std::uint32_t tailHalf;
+            std::memcpy(&headHalf, name.data(), sizeof(headHalf));
+            std::memcpy(&tailHalf, name.data() + name.size() - 4, sizeof(tailHalf));
+            return hasOnlyXmlNameBytes(headHalf | (std::uint64_t{ tailHalf } << 32));
+        }
+        for (std::size_t offset = 0; offset + 8 < name.size(); offset += 8) {
+            if (!hasOnlyXmlNameBytes(loadWord(name.data() + offset))) {
+                return false;
+            }
+        }
+        return hasOnlyXmlNameBytes(loadWord(name.data() + name.size() - 8));
+    }
+}
+
+inline void validateXmlName(std::string_view name) {
+    if (!isXmlName(name)) {
+        throw std::invalid_argument("Invalid XML name: " + std::string(name));
+    }
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "NumberFormat.h"
+#include "OutputSink.h"
+#include "OutputWriter.h"
+#include "Serializer.h"
+#include "SerializerOptions.h"
+#include "StringInternTable.h"
+#include "XmlEscapes.h"
+
+// IsPretty selects between indented output with one element per line and compact
+// output without whitespace between tags.
+template <bool IsPretty>
+class BasicXmlSerializer : public Serializer {
+private:
+    SerializerOptions options;
+    std::pmr::string blockNameStorage;
+    std::pmr::vector<std::size_t> blockNameOffsets;
+    OutputWriter output;
+    int currentIndentLevel = 0;
+
+    std::size_t getCurrentIndentSize() const {
+        if constexpr (IsPretty) {
+            return currentIndentLevel * 2;
+        }
+        else {
+            return 0;
+        }
+    }
+
+    // Names are never escaped; with escapeStrings on, a name that would break the
+    // markup is rejected instead.
+    void validateName(std::string_view name) const {
+        if (options.escapeStrings) {
+            validateXmlName(name);
+        }
+    }
+
+    std::size_t getTextSize(std::string_view text) const {
+        return options.escapeStrings ? text.size() * maxXmlEscapeExpansion : text.size();
+    }
+
+    void appendTextUnchecked(std::string_view text) {
+        if (options.escapeStrings) {
+            output.appendXmlEscapedUnchecked(text, options.simdLevel);
+        }
+        else {
+            output.appendUnchecked(text);
+        }
+    }
+
+    void appendFieldOpeningUnchecked(std::string_view fieldName) {
+        if constexpr (IsPretty) {
+            output.appendIndentUnchecked(getCurrentIndentSize());
+        }
+        output.appendUnchecked('<');
+        output.appendUnchecked(fieldName);
+        output.appendUnchecked('>');
+    }
+
+    void appendClosingTagUnchecked(std::string_view tagName) {
+        output.appendUnchecked("</");
+        output.appendUnchecked(tagName);
+        output.appendUnchecked(IsPretty ? ">\n" : ">");
+    }
+
+    std::size_t getFieldMarkupSize(std::string_view fieldName) const {
+        return getCurrentIndentSize() + fieldName.size() * 2 + 6;
+    }
+
+    void closeOpenBlocks() {
+        while (!blockNameOffsets.empty()) {
+            endBlock();
+        }
+    }
+
+public:
+    explicit BasicXmlSerializer(const SerializerOptions& serializerOptions = {})
+        : options(serializerOptions), blockNameStorage(options.memoryResource), blockNameOffsets(options.memoryResource), output(options.memoryResource) {
+        options.simdLevel = limitSimdLevel(options.simdLevel);
+    }
+
+    void addField(std::string_view fieldName, std::string_view fieldValue) override {
+        validateName(fieldName);
+        output.reserve(getFieldMarkupSize(fieldName) + getTextSize(fieldValue));
+        appendFieldOpeningUnchecked(fieldName);
+        appendTextUnchecked(fieldValue);
+        appendClosingTagUnchecked(fieldName);
+    }
+
+    void addField(std::string_view fieldName, int fieldValue) override {
+        validateName(fieldName);
+        output.reserve(getFieldMarkupSize(fieldName) + maxFormattedIntegerLength);
+        appendFieldOpeningUnchecked(fieldName);
+        output.appendIntegerUnchecked(fieldValue);
+        appendClosingTagUnchecked(fieldName);
+    }
+
+    void addField(std::string_view fieldName, double fieldValue) override {
+        validateName(fieldName);
+        output.reserve(getFieldMarkupSize(fieldName) + maxFormattedDoubleLength);
+        appendFieldOpeningUnchecked(fieldName);
+        output.appendDoubleUnchecked(fieldValue, options.doubleFormat);
+        appendClosingTagUnchecked(fieldName);
+    }
+
+    void addField(std::string_view fieldName, const InternedString& fieldValue) override {
+        validateName(fieldName);
+        std::string_view escapedValue = fieldValue.interned().xmlEscapedText;
+        output.reserve(getFieldMarkupSize(fieldName) + escapedValue.size());
+        appendFieldOpeningUnchecked(fieldName);
+        output.appendUnchecked(escapedValue);
+        appendClosingTagUnchecked(fieldName);
+    }
+
+    void addBlock(std::string_view blockName) override {
+        validateName(blockName);
+        output.reserve(getCurrentIndentSize() + blockName.size() + 3);
+        appendFieldOpeningUnchecked(blockName);
+        if constexpr (IsPretty) {
+            output.appendUnchecked('\n');
+            currentIndentLevel++;
+        }
+        blockNameOffsets.push_back(blockNameStorage.size());
+        blockNameStorage += blockName;
+    }
+
+    void endBlock() override {
+        if (!blockNameOffsets.empty()) {
+            if constexpr (IsPretty) {
+                currentIndentLevel--;
+            }
+            std::size_t lastBlockNameOffset = blockNameOffsets.back();
+            blockNameOffsets.pop_back();
+            std::string_view lastBlockName = std::string_view(blockNameStorage).substr(lastBlockNameOffset);
+            output.reserve(getCurrentIndentSize() + lastBlockName.size() + 4);
+            if constexpr (IsPretty) {
+                output.appendIndentUnchecked(getCurrentIndentSize());
+            }
+            appendClosingTagUnchecked(lastBlockName);
+            blockNameStorage.resize(lastBlockNameOffset);
+        }
+    }
+
+    void addArray(std::string_view arrayName) override {
+        addBlock(arrayName);
+    }
+
+    void endArray() override {
+        endBlock();
+    }
+
+    void reserve(std::size_t additionalSize) override {
+        output.reserveAhead(additionalSize);
+    }
+
+    std::size_t size() const override {
+        return output.size();
+    }
+
+    std::size_t nestingDepth() const override {
+        if constexpr (IsPretty) {
+            return currentIndentLevel;
+        }
+        else {
+            return blockNameOffsets.size();
+        }
+    }
+
+    void beginFragment(std::size_t fragmentDepth) override {
+        reset();
+        if constexpr (IsPretty) {
+            currentIndentLevel = static_cast<int>(fragmentDepth);
+        }
+    }
+
+    void appendFragment(std::string_view fragment, std::size_t) override {
+        output.append(fragment);
+    }
+
+    std::span<char> appendFragmentSpace(std::size_t fragmentSize, std::size_t) override {
+        return std::span<char>(output.appendUninitialized(fragmentSize), fragmentSize);
+    }
+
+    void setOutputSink(OutputSink* outputSink) override {
+        output.setSink(outputSink);
+    }
+
+    bool hasOutputSink() const override {
+        return output.hasSink();
+    }
+
+    void finish() override {
+        closeOpenBlocks();
+        output.flushToSink();
+    }
+
+    std::string build() override {
+        finish();
+        return std::string(output.view());
+    }
+
+    void buildInto(std::string& targetBuffer) override {
+        finish();
+        targetBuffer.assign(output.view());
+    }
+
+    std::string_view buildView() override {
+        finish();
+        return output.view();
+    }
+
+    std::pmr::string buildAndRelease() override {
+        finish();
+        std::pmr::string releasedContent = output.release();
+        reset();
+        return releasedContent;
+    }
+
+    void reset() override {
+        blockNameStorage.clear();
+        blockNameOffsets.clear();
+        output.clear();
+        currentIndentLevel = 0;
+    }
+};
+
+using XmlSerializer = BasicXmlSerializer<true>;
+using CompactXmlSerializer = BasicXmlSerializer<false>;
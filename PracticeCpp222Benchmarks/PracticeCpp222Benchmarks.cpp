@@ -0,0 +1,1303 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BatchArena.h"
+#include "CborReader.h"
+#include "IndexedJsonDeserializer.h"
+#include "JsonSerializer.h"
+#include "JsonDeserializer.h"
+#include "JsonStructuralIndex.h"
+#include "MappedFile.h"
+#include "MsgPackReader.h"
+#include "NumberFormat.h"
+#include "OutputSink.h"
+#include "OutputWriter.h"
+#include "ParallelBatchSerializer.h"
+#include "SerializerFactory.h"
+#include "SerializerOptions.h"
+#include "StaticSerializer.h"
+#include "Vehicle.h"
+#include "VehicleCollection.h"
+#include "VehicleFactory.h"
+#include "VehicleTable.h"
+#include "XmlDeserializer.h"
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static std::atomic<std::size_t> allocationCount{ 0 };
+
+void* operator new(std::size_t allocationSize) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* allocatedMemory = std::malloc(allocationSize == 0 ? 1 : allocationSize)) {
+        return allocatedMemory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* allocatedMemory) noexcept {
+    std::free(allocatedMemory);
+}
+
+void operator delete(void* allocatedMemory, std::size_t) noexcept {
+    std::free(allocatedMemory);
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned overloads.
+void* operator new(std::size_t allocationSize, std::align_val_t allocationAlignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    std::size_t alignment = static_cast<std::size_t>(allocationAlignment);
+    std::size_t alignedSize = (std::max<std::size_t>(allocationSize, 1) + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+    void* allocatedMemory = _aligned_malloc(alignedSize, alignment);
+#else
+    void* allocatedMemory = std::aligned_alloc(alignment, alignedSize);
+#endif
+    if (allocatedMemory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return allocatedMemory;
+}
+
+void operator delete(void* allocatedMemory, std::align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(allocatedMemory);
+#else
+    std::free(allocatedMemory);
+#endif
+}
+
+void operator delete(void* allocatedMemory, std::size_t, std::align_val_t allocationAlignment) noexcept {
+    operator delete(allocatedMemory, allocationAlignment);
+}
+
+struct BenchmarkResult {
+    std::string benchmarkName;
+    std::size_t recordCount = 0;
+    double nanosecondsPerRecord = 0;
+    double allocationsPerRecord = 0;
+    double bytesPerRecord = 0;
+    double megabytesPerSecond = 0;
+};
+
+struct SampleFleet {
+    Car bmwCar;
+    Airplane boeingPlane;
+    Ship victoriaShip;
+    std::vector<const Vehicle*> vehicleList;
+};
+
+static void fillSampleFleet(SampleFleet& sampleFleet, std::size_t recordCount) {
+    sampleFleet.bmwCar.modelName = "BMW G30";
+    sampleFleet.bmwCar.manufacturerName = "BMW";
+    sampleFleet.bmwCar.vehicleWeight = 1600;
+    sampleFleet.bmwCar.enginePower = 252;
+    sampleFleet.bmwCar.productionYear = 2020;
+    sampleFleet.bmwCar.doorCount = 4;
+    sampleFleet.bmwCar.passengerSeatCount = 5;
+    sampleFleet.bmwCar.fuelType = "petrol";
+    sampleFleet.bmwCar.engineVolume = 2.0;
+
+    sampleFleet.boeingPlane.modelName = "Boeing 747-400";
+    sampleFleet.boeingPlane.manufacturerName = "Boeing";
+    sampleFleet.boeingPlane.vehicleWeight = 180000;
+    sampleFleet.boeingPlane.enginePower = 240000;
+    sampleFleet.boeingPlane.productionYear = 1988;
+    sampleFleet.boeingPlane.wingSpan = 64;
+    sampleFleet.boeingPlane.maxAltitude = 13700;
+    sampleFleet.boeingPlane.maxPassengerCapacity = 416;
+    sampleFleet.boeingPlane.maxSpeed = 988;
+
+    sampleFleet.victoriaShip.modelName = "MS Queen Victoria";
+    sampleFleet.victoriaShip.manufacturerName = "Fincantieri";
+    sampleFleet.victoriaShip.vehicleWeight = 90000000;
+    sampleFleet.victoriaShip.enginePower = 120000;
+    sampleFleet.victoriaShip.productionYear = 2007;
+    sampleFleet.victoriaShip.shipLength = 294;
+    sampleFleet.victoriaShip.shipDisplacement = 90000;
+    sampleFleet.victoriaShip.crewCapacity = 1000;
+    sampleFleet.victoriaShip.propulsionType = "diesel-electric";
+
+    const Vehicle* sampleVehicles[] = { &sampleFleet.bmwCar, &sampleFleet.boeingPlane, &sampleFleet.victoriaShip };
+    sampleFleet.vehicleList.clear();
+    sampleFleet.vehicleList.reserve(recordCount);
+    for (std::size_t recordIndex = 0; recordIndex < recordCount; recordIndex++) {
+        sampleFleet.vehicleList.push_back(sampleVehicles[recordIndex % 3]);
+    }
+}
+
+template<class BenchmarkBody>
+static BenchmarkResult runBenchmark(const std::string& benchmarkName, std::size_t recordCount, BenchmarkBody benchmarkBody) {
+    std::size_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    auto startTime = std::chrono::steady_clock::now();
+    std::size_t producedBytes = benchmarkBody();
+    auto finishTime = std::chrono::steady_clock::now();
+    std::size_t allocationsAfter = allocationCount.load(std::memory_order_relaxed);
+
+    BenchmarkResult benchmarkResult;
+    benchmarkResult.benchmarkName = benchmarkName;
+    benchmarkResult.recordCount = recordCount;
+    benchmarkResult.nanosecondsPerRecord = std::chrono::duration<double, std::nano>(finishTime - startTime).count() / recordCount;
+    benchmarkResult.allocationsPerRecord = static_cast<double>(allocationsAfter - allocationsBefore) / recordCount;
+    benchmarkResult.bytesPerRecord = static_cast<double>(producedBytes) / recordCount;
+    benchmarkResult.megabytesPerSecond = static_cast<double>(producedBytes) * 1000.0 / std::chrono::duration<double, std::nano>(finishTime - startTime).count();
+    return benchmarkResult;
+}
+
+static BenchmarkResult benchmarkFreshSerializerPerRecord(const std::string& outputFormat, const SampleFleet& sampleFleet) {
+    return runBenchmark(outputFormat + "/fresh-serializer-per-record", sampleFleet.vehicleList.size(), [&] {
+        std::size_t producedBytes = 0;
+        for (const Vehicle* currentVehicle : sampleFleet.vehicleList) {
+            auto formatSerializer = createSerializer(outputFormat);
+            serializeVehicle(*currentVehicle, *formatSerializer);
+            producedBytes += formatSerializer->build().size();
+        }
+        return producedBytes;
+    });
+}
+
+static BenchmarkResult benchmarkReusedSerializer(const std::string& outputFormat, const SampleFleet& sampleFleet) {
+    auto formatSerializer = createSerializer(outputFormat);
+    std::string serializedDocument;
+    for (std::size_t warmupIndex = 0; warmupIndex < 3 && warmupIndex < sampleFleet.vehicleList.size(); warmupIndex++) {
+        serializeVehicle(*sampleFleet.vehicleList[warmupIndex], *formatSerializer);
+        formatSerializer->buildInto(serializedDocument);
+        formatSerializer->reset();
+    }
+
+    return runBenchmark(outputFormat + "/reused-serializer", sampleFleet.vehicleList.size(), [&] {
+        std::size_t producedBytes = 0;
+        for (const Vehicle* currentVehicle : sampleFleet.vehicleList) {
+            serializeVehicle(*currentVehicle, *formatSerializer);
+            formatSerializer->buildInto(serializedDocument);
+            producedBytes += serializedDocument.size();
+            formatSerializer->reset();
+        }
+        return producedBytes;
+    });
+}
+
+static BenchmarkResult benchmarkStreamingToMemorySpan(const std::string& outputFormat, const SampleFleet& sampleFleet) {
+    std::vector<char> targetMemory(sampleFleet.vehicleList.size() * 512);
+    MemorySpanOutputSink memorySink(targetMemory.data(), targetMemory.size());
+    auto formatSerializer = createSerializer(outputFormat);
+    formatSerializer->setOutputSink(&memorySink);
+
+    return runBenchmark(outputFormat + "/stream-to-memory-span", sampleFleet.vehicleList.size(), [&] {
+        for (const Vehicle* currentVehicle : sampleFleet.vehicleList) {
+            serializeVehicle(*currentVehicle, *formatSerializer);
+            formatSerializer->finish();
+            formatSerializer->reset();
+        }
+        return memorySink.size();
+    });
+}
+
+static std::string getLayoutName(const std::string& outputFormat, const SerializerOptions& serializerOptions) {
+    std::string layoutName = serializerOptions.pretty ? outputFormat : outputFormat + "-compact";
+    return serializerOptions.collectMetrics ? layoutName + "-metrics" : layoutName;
+}
+
+// The shape every document benchmark shares: one serializer, warmed up by a first
+// document, then documentCount documents per measurement, each written into it by
+// serializeDocument, built into the same string and reset.
+template<class SerializeDocument>
+static BenchmarkResult benchmarkDocuments(const std::string& benchmarkName, const std::string& outputFormat, const SerializerOptions& serializerOptions, std::size_t recordsPerDocument, std::size_t documentCount, SerializeDocument serializeDocument) {
+    auto formatSerializer = createSerializer(outputFormat, serializerOptions);
+    std::string serializedDocument;
+    serializeDocument(*formatSerializer);
+    formatSerializer->buildInto(serializedDocument);
+    formatSerializer->reset();
+
+    return runBenchmark(benchmarkName, recordsPerDocument * documentCount, [&] {
+        std::size_t producedBytes = 0;
+        for (std::size_t documentIndex = 0; documentIndex < documentCount; documentIndex++) {
+            serializeDocument(*formatSerializer);
+            formatSerializer->buildInto(serializedDocument);
+            producedBytes += serializedDocument.size();
+            formatSerializer->reset();
+        }
+        return producedBytes;
+    });
+}
+
+static BenchmarkResult benchmarkVehicleListDocument(const std::string& benchmarkName, const std::string& outputFormat, const std::vector<const Vehicle*>& vehicleList, const SerializerOptions& serializerOptions = {}, std::size_t documentCount = 1) {
+    return benchmarkDocuments(benchmarkName, outputFormat, serializerOptions, vehicleList.size(), documentCount, [&](Serializer& formatSerializer) {
+        serializeVehicles(vehicleList, formatSerializer);
+    });
+}
+
+// Same vehicle kinds as the sample fleet, but the first eighth of the list is made of
+// ships with kilobyte-long strings, so the cost per record is concentrated in one place.
+static void fillSkewedFleet(SampleFleet& skewedFleet, const SampleFleet& sampleFleet, std::size_t recordCount) {
+    skewedFleet.bmwCar = sampleFleet.bmwCar;
+    skewedFleet.boeingPlane = sampleFleet.boeingPlane;
+    skewedFleet.victoriaShip = sampleFleet.victoriaShip;
+    skewedFleet.victoriaShip.modelName.append(2048, 'Q');
+    skewedFleet.victoriaShip.propulsionType = std::string(sampleFleet.victoriaShip.propulsionType.view()) + std::string(2048, 'd');
+
+    const Vehicle* lightVehicles[] = { &skewedFleet.bmwCar, &skewedFleet.boeingPlane };
+    skewedFleet.vehicleList.clear();
+    skewedFleet.vehicleList.reserve(recordCount);
+    for (std::size_t recordIndex = 0; recordIndex < recordCount; recordIndex++) {
+        if (recordIndex < recordCount / 8) {
+            skewedFleet.vehicleList.push_back(&skewedFleet.victoriaShip);
+        }
+        else {
+            skewedFleet.vehicleList.push_back(lightVehicles[recordIndex % 2]);
+        }
+    }
+}
+
+static BenchmarkResult benchmarkParallelBatchDocument(const std::string& benchmarkName, const std::string& outputFormat, std::size_t threadCount, BatchScheduling batchScheduling, const SampleFleet& sampleFleet) {
+    ParallelBatchSerializer batchSerializer(outputFormat, threadCount, {}, batchScheduling);
+    Serializer& documentSerializer = batchSerializer.documentSerializer();
+    std::string serializedDocument;
+    batchSerializer.serializeVehicles(sampleFleet.vehicleList);
+    documentSerializer.buildInto(serializedDocument);
+    documentSerializer.reset();
+
+    const char* schedulingName = batchScheduling == BatchScheduling::WorkStealing ? "/stealing/" : "/static/";
+    return runBenchmark(outputFormat + "/" + benchmarkName + schedulingName + std::to_string(threadCount) + "t", sampleFleet.vehicleList.size(), [&] {
+        batchSerializer.serializeVehicles(sampleFleet.vehicleList);
+        documentSerializer.buildInto(serializedDocument);
+        documentSerializer.reset();
+        return serializedDocument.size();
+    });
+}
+
+static BenchmarkResult benchmarkJsonDeserializeBatch(const SampleFleet& sampleFleet, const SerializerOptions& serializerOptions = {}) {
+    auto formatSerializer = createSerializer("json", serializerOptions);
+    serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+    std::string serializedDocument = formatSerializer->build();
+    StringInternTable internTable;
+
+    return runBenchmark(getLayoutName("json", serializerOptions) + "/deserialize-batch", sampleFleet.vehicleList.size(), [&] {
+        JsonDeserializer jsonDeserializer(serializedDocument);
+        std::vector<std::unique_ptr<Vehicle>> vehicleList = deserializeVehicles(jsonDeserializer, internTable);
+        jsonDeserializer.finish();
+        return serializedDocument.size();
+    });
+}
+
+static BenchmarkResult benchmarkXmlDeserializeBatch(const SampleFleet& sampleFleet, const SerializerOptions& serializerOptions = {}) {
+    auto formatSerializer = createSerializer("xml", serializerOptions);
+    serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+    std::string serializedDocument = formatSerializer->build();
+    StringInternTable internTable;
+
+    return runBenchmark(getLayoutName("xml", serializerOptions) + "/deserialize-batch", sampleFleet.vehicleList.size(), [&] {
+        XmlDeserializer xmlDeserializer(serializedDocument);
+        std::vector<std::unique_ptr<Vehicle>> vehicleList = deserializeVehicles(xmlDeserializer, internTable);
+        xmlDeserializer.finish();
+        return serializedDocument.size();
+    });
+}
+
+static std::string getExportPath(const std::string& outputFormat) {
+    return (std::filesystem::temp_directory_path() / ("PracticeCpp222Benchmarks-export." + outputFormat)).string();
+}
+
+static BenchmarkResult benchmarkExportThroughStream(const std::string& outputFormat, const SampleFleet& sampleFleet) {
+    auto formatSerializer = createSerializer(outputFormat);
+    return runBenchmark(outputFormat + "/export/ofstream", sampleFleet.vehicleList.size(), [&] {
+        std::ofstream exportStream(getExportPath(outputFormat), std::ios::binary | std::ios::trunc);
+        StreamOutputSink streamSink(exportStream);
+        formatSerializer->setOutputSink(&streamSink);
+        serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+        formatSerializer->finish();
+        formatSerializer->setOutputSink(nullptr);
+        formatSerializer->reset();
+        exportStream.close();
+        return static_cast<std::size_t>(std::filesystem::file_size(getExportPath(outputFormat)));
+    });
+}
+
+static BenchmarkResult benchmarkExportThroughMapping(const std::string& outputFormat, const SampleFleet& sampleFleet) {
+    auto formatSerializer = createSerializer(outputFormat);
+    return runBenchmark(outputFormat + "/export/mapped-file", sampleFleet.vehicleList.size(), [&] {
+        MappedFileSink mappedSink(getExportPath(outputFormat), sampleFleet.vehicleList.size() * 512);
+        formatSerializer->setOutputSink(&mappedSink);
+        serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+        formatSerializer->finish();
+        formatSerializer->setOutputSink(nullptr);
+        formatSerializer->reset();
+        mappedSink.close();
+        return mappedSink.size();
+    });
+}
+
+static BenchmarkResult benchmarkXmlImportThroughStream(const SampleFleet& sampleFleet) {
+    StringInternTable internTable;
+
+    return runBenchmark("xml/import/ifstream", sampleFleet.vehicleList.size(), [&] {
+        std::ifstream importStream(getExportPath("xml"), std::ios::binary);
+        std::string importedDocument((std::istreambuf_iterator<char>(importStream)), std::istreambuf_iterator<char>());
+        XmlDeserializer xmlDeserializer(importedDocument);
+        std::vector<std::unique_ptr<Vehicle>> vehicleList = deserializeVehicles(xmlDeserializer, internTable);
+        xmlDeserializer.finish();
+        return importedDocument.size();
+    });
+}
+
+static BenchmarkResult benchmarkXmlImportThroughMapping(const SampleFleet& sampleFleet) {
+    StringInternTable internTable;
+
+    return runBenchmark("xml/import/mapped-file", sampleFleet.vehicleList.size(), [&] {
+        MappedFileSource mappedSource(getExportPath("xml"));
+        XmlDeserializer xmlDeserializer(mappedSource.span());
+        std::vector<std::unique_ptr<Vehicle>> vehicleList = deserializeVehicles(xmlDeserializer, internTable);
+        xmlDeserializer.finish();
+        return mappedSource.size();
+    });
+}
+
+// Every record is its own heap object, unlike the sample fleet which points at three.
+struct HeapFleet {
+    std::vector<std::unique_ptr<Vehicle>> ownedVehicles;
+    std::vector<const Vehicle*> vehicleList;
+};
+
+static void fillHeapFleet(HeapFleet& heapFleet, const SampleFleet& sampleFleet) {
+    heapFleet.ownedVehicles.clear();
+    heapFleet.vehicleList.clear();
+    for (const Vehicle* sampleVehicle : sampleFleet.vehicleList) {
+        if (const Car* car = dynamic_cast<const Car*>(sampleVehicle)) {
+            heapFleet.ownedVehicles.push_back(std::make_unique<Car>(*car));
+        }
+        else if (const Airplane* airplane = dynamic_cast<const Airplane*>(sampleVehicle)) {
+            heapFleet.ownedVehicles.push_back(std::make_unique<Airplane>(*airplane));
+        }
+        else {
+            heapFleet.ownedVehicles.push_back(std::make_unique<Ship>(static_cast<const Ship&>(*sampleVehicle)));
+        }
+        heapFleet.vehicleList.push_back(heapFleet.ownedVehicles.back().get());
+    }
+}
+
+static std::string getAllocationName(const BatchArena* batchArena) {
+    return batchArena != nullptr ? "arena" : "heap";
+}
+
+// Ingest and export one batch with everything allocated either from the default
+// heap or from a batch arena that is released once the batch is done.
+static BenchmarkResult benchmarkIngestBatch(const std::string& outputFormat, const SampleFleet& sampleFleet, BatchArena* batchArena) {
+    auto formatSerializer = createSerializer(outputFormat);
+    serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+    std::string serializedDocument = formatSerializer->build();
+    std::pmr::memory_resource* memoryResource = batchArena != nullptr ? batchArena->resource() : std::pmr::get_default_resource();
+
+    return runBenchmark(outputFormat + "/ingest-batch/" + getAllocationName(batchArena), sampleFleet.vehicleList.size(), [&] {
+        {
+            VehicleCollection vehicleCollection(memoryResource);
+            if (outputFormat == "xml") {
+                XmlDeserializer xmlDeserializer(serializedDocument, memoryResource);
+                deserializeVehicleCollection(xmlDeserializer, vehicleCollection);
+                xmlDeserializer.finish();
+            }
+            else {
+                JsonDeserializer jsonDeserializer(serializedDocument, memoryResource);
+                deserializeVehicleCollection(jsonDeserializer, vehicleCollection);
+                jsonDeserializer.finish();
+            }
+        }
+        if (batchArena != nullptr) {
+            batchArena->release();
+        }
+        return serializedDocument.size();
+    });
+}
+
+static BenchmarkResult benchmarkExportBatch(const std::string& outputFormat, const VehicleCollection& vehicleCollection, BatchArena* batchArena) {
+    SerializerOptions serializerOptions;
+    if (batchArena != nullptr) {
+        serializerOptions.memoryResource = batchArena->resource();
+    }
+
+    return runBenchmark(outputFormat + "/export-batch/" + getAllocationName(batchArena), vehicleCollection.size(), [&] {
+        std::size_t documentSize;
+        {
+            auto formatSerializer = createSerializer(outputFormat, serializerOptions);
+            serializeVehicleCollection(vehicleCollection, *formatSerializer);
+            documentSize = formatSerializer->buildAndRelease().size();
+        }
+        if (batchArena != nullptr) {
+            batchArena->release();
+        }
+        return documentSize;
+    });
+}
+
+// Copies every vehicle of the collection into a fresh one. Interned attributes are
+// copied as handles, so only model names that outgrow the small-string buffer allocate.
+static BenchmarkResult benchmarkVehicleCollectionCopy(const VehicleCollection& vehicleCollection) {
+    return runBenchmark("copy-collection", vehicleCollection.size(), [&] {
+        VehicleCollection copiedCollection;
+        std::size_t copiedBytes = 0;
+        vehicleCollection.forEach([&](const auto& vehicle) {
+            copiedCollection.insert(vehicle);
+            copiedBytes += sizeof(vehicle);
+        });
+        return copiedBytes;
+    });
+}
+
+static BenchmarkResult benchmarkHeapFleetWeightScan(const HeapFleet& heapFleet) {
+    return runBenchmark("scan-weights/heap-objects", heapFleet.vehicleList.size(), [&] {
+        double totalWeight = 0;
+        for (const Vehicle* vehicle : heapFleet.vehicleList) {
+            totalWeight += vehicle->vehicleWeight;
+        }
+        return totalWeight > 0 ? heapFleet.vehicleList.size() * sizeof(double) : 0;
+    });
+}
+
+static BenchmarkResult benchmarkVehicleTableWeightScan(const VehicleTable& vehicleTable) {
+    return runBenchmark("scan-weights/vehicle-table", vehicleTable.size(), [&] {
+        double totalWeight = 0;
+        for (double vehicleWeight : vehicleTable.weights()) {
+            totalWeight += vehicleWeight;
+        }
+        return totalWeight > 0 ? vehicleTable.size() * sizeof(double) : 0;
+    });
+}
+
+static std::string getSimdLevelName(SimdLevel simdLevel) {
+    switch (simdLevel) {
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+static std::string getEscapingName(const SerializerOptions& serializerOptions) {
+    return serializerOptions.escapeStrings ? getSimdLevelName(serializerOptions.simdLevel) : "unescaped";
+}
+
+static SerializerOptions makeEscapingOptions(bool isEscaping, SimdLevel simdLevel) {
+    SerializerOptions serializerOptions;
+    serializerOptions.escapeStrings = isEscaping;
+    serializerOptions.simdLevel = simdLevel;
+    return serializerOptions;
+}
+
+static BenchmarkResult benchmarkEscapedBatchDocument(const std::string& outputFormat, const SampleFleet& sampleFleet, const SerializerOptions& serializerOptions) {
+    auto formatSerializer = createSerializer(outputFormat, serializerOptions);
+    std::string serializedDocument;
+    serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+    formatSerializer->buildInto(serializedDocument);
+    formatSerializer->reset();
+
+    // The overhead being measured is a few percent, so average over several passes.
+    const std::size_t passCount = 8;
+    return runBenchmark(outputFormat + "/escape-batch/" + getEscapingName(serializerOptions), sampleFleet.vehicleList.size() * passCount, [&] {
+        std::size_t producedBytes = 0;
+        for (std::size_t passIndex = 0; passIndex < passCount; passIndex++) {
+            serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+            formatSerializer->buildInto(serializedDocument);
+            formatSerializer->reset();
+            producedBytes += serializedDocument.size();
+        }
+        return producedBytes;
+    });
+}
+
+// Model and manufacturer names as they show up in real fleets: mostly short, clean
+// ASCII or UTF-8, with the occasional quote or ampersand.
+static std::vector<std::string> makeSampleVehicleNames(std::size_t nameCount) {
+    const char* sampleNames[] = {
+        "BMW G30", "Boeing 747-400", "MS Queen Victoria", "Mercedes-Benz S 580 4MATIC Long",
+        "Airbus A350-900 XWB", "Škoda Octavia Combi", "Rolls & Royce Phantom", "Citroën C5 Aircross",
+        "Embraer E195-E2", "Harmony of the Seas", "Toyota Land Cruiser 300 \"GR Sport\"", "Lada Niva Legend"
+    };
+    std::vector<std::string> sampleVehicleNames;
+    sampleVehicleNames.reserve(nameCount);
+    for (std::size_t nameIndex = 0; nameIndex < nameCount; nameIndex++) {
+        sampleVehicleNames.push_back(sampleNames[nameIndex % std::size(sampleNames)]);
+    }
+    return sampleVehicleNames;
+}
+
+static BenchmarkResult benchmarkEscapeNames(const std::string& outputFormat, const std::vector<std::string>& sampleVehicleNames, const SerializerOptions& serializerOptions) {
+    SimdLevel simdLevel = limitSimdLevel(serializerOptions.simdLevel);
+    bool isXml = outputFormat == "xml";
+
+    return runBenchmark(outputFormat + "/escape-names/" + getEscapingName(serializerOptions), sampleVehicleNames.size(), [&] {
+        OutputWriter escapedOutput;
+        std::size_t scannedBytes = 0;
+        for (const std::string& vehicleName : sampleVehicleNames) {
+            escapedOutput.reserve(vehicleName.size() * maxJsonEscapeExpansion);
+            if (!serializerOptions.escapeStrings) {
+                escapedOutput.appendUnchecked(vehicleName);
+            }
+            else if (isXml) {
+                escapedOutput.appendXmlEscapedUnchecked(vehicleName, simdLevel);
+            }
+            else {
+                escapedOutput.appendJsonEscapedUnchecked(vehicleName, simdLevel);
+            }
+            scannedBytes += vehicleName.size();
+            escapedOutput.clear();
+        }
+        return scannedBytes;
+    });
+}
+
+static BenchmarkResult benchmarkJsonStructuralIndex(const SampleFleet& sampleFleet, SimdLevel simdLevel, const SerializerOptions& serializerOptions = {}) {
+    auto formatSerializer = createSerializer("json", serializerOptions);
+    serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+    std::string serializedDocument = formatSerializer->build();
+    JsonStructuralIndex structuralIndex;
+    structuralIndex.build(serializedDocument, simdLevel);
+
+    return runBenchmark(getLayoutName("json", serializerOptions) + "/structural-index/" + getSimdLevelName(simdLevel), sampleFleet.vehicleList.size(), [&] {
+        structuralIndex.build(serializedDocument, simdLevel);
+        return serializedDocument.size();
+    });
+}
+
+static BenchmarkResult benchmarkIndexedJsonDeserializeBatch(const SampleFleet& sampleFleet, SimdLevel simdLevel, const SerializerOptions& serializerOptions = {}) {
+    auto formatSerializer = createSerializer("json", serializerOptions);
+    serializeVehicles(sampleFleet.vehicleList, *formatSerializer);
+    std::string serializedDocument = formatSerializer->build();
+    IndexedJsonDeserializer jsonDeserializer(serializedDocument, simdLevel);
+    StringInternTable internTable;
+
+    return runBenchmark(getLayoutName("json", serializerOptions) + "/indexed-deserialize-batch/" + getSimdLevelName(simdLevel), sampleFleet.vehicleList.size(), [&] {
+        jsonDeserializer.reset(serializedDocument);
+        std::vector<std::unique_ptr<Vehicle>> vehicleList = deserializeVehicles(jsonDeserializer, internTable);
+        jsonDeserializer.finish();
+        return serializedDocument.size();
+    });
+}
+
+// Each vehicle kind of the sample fleet on its own, one record per document.
+static void benchmarkEachVehicleKind(std::vector<BenchmarkResult>& benchmarkResults, const std::string& outputFormat, const SampleFleet& sampleFleet, std::size_t recordCount, const SerializerOptions& serializerOptions = {}) {
+    const std::pair<std::string, const Vehicle*> namedVehicles[] = {
+        { "car", &sampleFleet.bmwCar },
+        { "airplane", &sampleFleet.boeingPlane },
+        { "ship", &sampleFleet.victoriaShip },
+    };
+    for (const auto& [vehicleKind, sampleVehicle] : namedVehicles) {
+        benchmarkResults.push_back(benchmarkDocuments(getLayoutName(outputFormat, serializerOptions) + "/" + vehicleKind, outputFormat, serializerOptions, 1, recordCount, [sampleVehicle](Serializer& formatSerializer) {
+            serializeVehicle(*sampleVehicle, formatSerializer);
+        }));
+    }
+}
+
+template<class StaticSerializerType, class VehicleType>
+static BenchmarkResult benchmarkStaticVehicleKind(const std::string& benchmarkName, const VehicleType& sampleVehicle, std::size_t recordCount) {
+    StaticSerializerType staticSerializer;
+    std::string serializedDocument;
+    sampleVehicle.serializeTo(staticSerializer.document());
+    staticSerializer.buildInto(serializedDocument);
+    staticSerializer.reset();
+
+    return runBenchmark(benchmarkName, recordCount, [&] {
+        std::size_t producedBytes = 0;
+        for (std::size_t recordIndex = 0; recordIndex < recordCount; recordIndex++) {
+            sampleVehicle.serializeTo(staticSerializer.document());
+            staticSerializer.buildInto(serializedDocument);
+            producedBytes += serializedDocument.size();
+            staticSerializer.reset();
+        }
+        return producedBytes;
+    });
+}
+
+// The regression matrix: each format over fleets of one vehicle kind and over the
+// three kinds interleaved, at sizes from a single record to a million. A fleet is one
+// document; small fleets are serialized repeatedly so that every measurement covers at
+// least minimumMeasuredRecords records.
+static std::vector<const Vehicle*> makeFleetList(const SampleFleet& sampleFleet, const std::string& fleetKind, std::size_t fleetSize) {
+    if (fleetKind == "mixed") {
+        return std::vector<const Vehicle*>(sampleFleet.vehicleList.begin(), sampleFleet.vehicleList.begin() + fleetSize);
+    }
+    const Vehicle* fleetVehicle = &sampleFleet.bmwCar;
+    if (fleetKind == "airplane") {
+        fleetVehicle = &sampleFleet.boeingPlane;
+    }
+    else if (fleetKind == "ship") {
+        fleetVehicle = &sampleFleet.victoriaShip;
+    }
+    return std::vector<const Vehicle*>(fleetSize, fleetVehicle);
+}
+
+static void runFleetMatrix(std::vector<BenchmarkResult>& benchmarkResults) {
+    const std::size_t fleetSizes[] = { 1, 1000, 1000000 };
+    const std::size_t minimumMeasuredRecords = 100000;
+    SampleFleet sampleFleet;
+    fillSampleFleet(sampleFleet, fleetSizes[std::size(fleetSizes) - 1]);
+
+    for (const std::string outputFormat : { "xml", "json" }) {
+        for (const std::string fleetKind : { "car", "airplane", "ship", "mixed" }) {
+            for (std::size_t fleetSize : fleetSizes) {
+                std::vector<const Vehicle*> fleetList = makeFleetList(sampleFleet, fleetKind, fleetSize);
+                std::size_t repetitionCount = std::max<std::size_t>(1, minimumMeasuredRecords / fleetSize);
+                benchmarkResults.push_back(benchmarkVehicleListDocument(outputFormat + "/fleet/" + fleetKind + "/" + std::to_string(fleetSize), outputFormat, fleetList, {}, repetitionCount));
+            }
+        }
+    }
+}
+
+static std::vector<double> makeSampleDoubles(std::size_t valueCount) {
+    const double sampleValues[] = { 1600, 252, 2.0, 180000, 240000, 988, 90000000, 294, 90000, 1.6, 0.1, 123.456, 9.81e-3, 299792.458 };
+    std::vector<double> sampleDoubles;
+    sampleDoubles.reserve(valueCount);
+    for (std::size_t valueIndex = 0; valueIndex < valueCount; valueIndex++) {
+        sampleDoubles.push_back(sampleValues[valueIndex % std::size(sampleValues)]);
+    }
+    return sampleDoubles;
+}
+
+static BenchmarkResult benchmarkToStringDoubles(const std::vector<double>& sampleDoubles) {
+    return runBenchmark("double/std::to_string", sampleDoubles.size(), [&] {
+        std::string formattedOutput;
+        std::size_t producedBytes = 0;
+        for (double sampleDouble : sampleDoubles) {
+            formattedOutput += std::to_string(sampleDouble);
+            producedBytes += formattedOutput.size();
+            formattedOutput.clear();
+        }
+        return producedBytes;
+    });
+}
+
+static BenchmarkResult benchmarkFormatDoubles(const std::string& modeName, const DoubleFormat& doubleFormat, const std::vector<double>& sampleDoubles) {
+    return runBenchmark("double/formatDouble-" + modeName, sampleDoubles.size(), [&] {
+        OutputWriter formattedOutput;
+        std::size_t producedBytes = 0;
+        for (double sampleDouble : sampleDoubles) {
+            formattedOutput.appendDouble(sampleDouble, doubleFormat);
+            producedBytes += formattedOutput.size();
+            formattedOutput.clear();
+        }
+        return producedBytes;
+    });
+}
+
+static std::vector<int> makeSampleIntegers(std::size_t valueCount) {
+    const int sampleValues[] = { 2020, 1988, 2007, 4, 5, 64, 13700, 416, 1000, -273, 123456789 };
+    std::vector<int> sampleIntegers;
+    sampleIntegers.reserve(valueCount);
+    for (std::size_t valueIndex = 0; valueIndex < valueCount; valueIndex++) {
+        sampleIntegers.push_back(sampleValues[valueIndex % std::size(sampleValues)]);
+    }
+    return sampleIntegers;
+}
+
+static BenchmarkResult benchmarkToStringIntegers(const std::vector<int>& sampleIntegers) {
+    return runBenchmark("int/std::to_string", sampleIntegers.size(), [&] {
+        std::string formattedOutput;
+        std::size_t producedBytes = 0;
+        for (int sampleInteger : sampleIntegers) {
+            formattedOutput += std::to_string(sampleInteger);
+            producedBytes += formattedOutput.size();
+            formattedOutput.clear();
+        }
+        return producedBytes;
+    });
+}
+
+static BenchmarkResult benchmarkFormatIntegers(const std::vector<int>& sampleIntegers) {
+    return runBenchmark("int/formatInteger", sampleIntegers.size(), [&] {
+        OutputWriter formattedOutput;
+        std::size_t producedBytes = 0;
+        for (int sampleInteger : sampleIntegers) {
+            formattedOutput.appendInteger(sampleInteger);
+            producedBytes += formattedOutput.size();
+            formattedOutput.clear();
+        }
+        return producedBytes;
+    });
+}
+
+static void printResultsAsTable(const std::vector<BenchmarkResult>& benchmarkResults) {
+    std::cout << std::left << std::setw(48) << "benchmark"
+        << std::right << std::setw(10) << "records"
+        << std::setw(14) << "ns/record"
+        << std::setw(14) << "allocs/record"
+        << std::setw(14) << "bytes/record"
+        << std::setw(10) << "MB/s" << "\n";
+    for (const BenchmarkResult& benchmarkResult : benchmarkResults) {
+        std::cout << std::left << std::setw(48) << benchmarkResult.benchmarkName
+            << std::right << std::setw(10) << benchmarkResult.recordCount
+            << std::fixed << std::setprecision(1)
+            << std::setw(14) << benchmarkResult.nanosecondsPerRecord
+            << std::setprecision(2)
+            << std::setw(14) << benchmarkResult.allocationsPerRecord
+            << std::setprecision(1)
+            << std::setw(14) << benchmarkResult.bytesPerRecord
+            << std::setw(10) << benchmarkResult.megabytesPerSecond << "\n";
+    }
+}
+
+// The JSON report goes through the project's own serializer, so its layout follows
+// the vehicle documents: {"simdLevel": ..., "benchmarks": [{...}, ...]}.
+static void printResultsAsJson(const std::vector<BenchmarkResult>& benchmarkResults) {
+    SerializerOptions reportOptions;
+    reportOptions.doubleFormat = { DoubleFormatMode::FixedPrecision, 3 };
+    JsonSerializer reportSerializer(reportOptions);
+    reportSerializer.addField("simdLevel", getSimdLevelName(limitSimdLevel(SimdLevel::Avx2)));
+    reportSerializer.addArray("benchmarks");
+    for (const BenchmarkResult& benchmarkResult : benchmarkResults) {
+        reportSerializer.addBlock("benchmark");
+        reportSerializer.addField("name", benchmarkResult.benchmarkName);
+        reportSerializer.addField("records", static_cast<int>(benchmarkResult.recordCount));
+        reportSerializer.addField("nsPerRecord", benchmarkResult.nanosecondsPerRecord);
+        reportSerializer.addField("allocationsPerRecord", benchmarkResult.allocationsPerRecord);
+        reportSerializer.addField("bytesPerRecord", benchmarkResult.bytesPerRecord);
+        reportSerializer.addField("megabytesPerSecond", benchmarkResult.megabytesPerSecond);
+        reportSerializer.endBlock();
+    }
+    reportSerializer.endArray();
+    std::cout << reportSerializer.build() << "\n";
+}
+
+static void printResults(const std::vector<BenchmarkResult>& benchmarkResults, bool isJsonOutput) {
+    if (isJsonOutput) {
+        printResultsAsJson(benchmarkResults);
+    }
+    else {
+        printResultsAsTable(benchmarkResults);
+    }
+}
+
+// Vehicles whose values exercise the edges of every format: the int limits, negative
+// integers just past the CBOR and MessagePack width boundaries, strings longer than
+// the one- and two-byte CBOR length forms, and text that JSON and XML must escape.
+static void fillEdgeCaseFleet(SampleFleet& edgeCaseFleet) {
+    const std::string escapedText = "quote\" backslash\\ slash/ tab\t newline\n bell\x07 nul" + std::string(1, '\0') + " <&> 'apos' \xC3\xA9\xE2\x82\xAC";
+    const std::string longText = std::string(70000, 'L') + escapedText;
+
+    edgeCaseFleet.bmwCar.modelName = escapedText;
+    edgeCaseFleet.bmwCar.manufacturerName = "";
+    edgeCaseFleet.bmwCar.vehicleWeight = -1600.25;
+    edgeCaseFleet.bmwCar.enginePower = -0.0;
+    edgeCaseFleet.bmwCar.productionYear = INT_MIN;
+    edgeCaseFleet.bmwCar.doorCount = -33;
+    edgeCaseFleet.bmwCar.passengerSeatCount = INT_MAX;
+    edgeCaseFleet.bmwCar.fuelType = escapedText;
+    edgeCaseFleet.bmwCar.engineVolume = 1e-300;
+
+    edgeCaseFleet.boeingPlane.modelName = longText;
+    edgeCaseFleet.boeingPlane.manufacturerName = escapedText;
+    edgeCaseFleet.boeingPlane.vehicleWeight = 1.7976931348623157e308;
+    edgeCaseFleet.boeingPlane.enginePower = -240000.125;
+    edgeCaseFleet.boeingPlane.productionYear = -1;
+    edgeCaseFleet.boeingPlane.wingSpan = -32769;
+    edgeCaseFleet.boeingPlane.maxAltitude = INT_MIN + 1;
+    edgeCaseFleet.boeingPlane.maxPassengerCapacity = INT_MIN;
+    edgeCaseFleet.boeingPlane.maxSpeed = 4294967296.5;
+
+    edgeCaseFleet.victoriaShip.modelName = std::string(300, 'S');
+    edgeCaseFleet.victoriaShip.manufacturerName = longText;
+    edgeCaseFleet.victoriaShip.vehicleWeight = -90000000;
+    edgeCaseFleet.victoriaShip.enginePower = 0.1;
+    edgeCaseFleet.victoriaShip.productionYear = INT_MAX;
+    edgeCaseFleet.victoriaShip.shipLength = -294;
+    edgeCaseFleet.victoriaShip.shipDisplacement = -1e20;
+    edgeCaseFleet.victoriaShip.crewCapacity = -65537;
+    edgeCaseFleet.victoriaShip.propulsionType = escapedText;
+
+    edgeCaseFleet.vehicleList = { &edgeCaseFleet.bmwCar, &edgeCaseFleet.boeingPlane, &edgeCaseFleet.victoriaShip };
+}
+
+static void reportMismatch(const std::string& checkName, std::string_view expectedDocument, std::string_view actualDocument) {
+    std::size_t mismatchPosition = 0;
+    while (mismatchPosition < expectedDocument.size() && mismatchPosition < actualDocument.size()
+        && expectedDocument[mismatchPosition] == actualDocument[mismatchPosition]) {
+        mismatchPosition++;
+    }
+    std::size_t contextBegin = mismatchPosition < 40 ? 0 : mismatchPosition - 40;
+    std::cerr << "Self-check failed: " << checkName << "\n"
+        << "  sizes " << expectedDocument.size() << " (expected) and " << actualDocument.size() << " (actual), first difference at byte " << mismatchPosition << "\n"
+        << "  expected: " << std::quoted(expectedDocument.substr(contextBegin, 80)) << "\n"
+        << "  actual:   " << std::quoted(actualDocument.substr(contextBegin, 80)) << "\n";
+}
+
+// Repeats the sample vehicles recordCount times with an edge-case vehicle every 250
+// records, so that a list is long enough to need wide container headers.
+static std::vector<const Vehicle*> buildMixedVehicleList(const SampleFleet& sampleFleet, const SampleFleet& edgeCaseFleet, std::size_t recordCount) {
+    std::vector<const Vehicle*> mixedVehicleList;
+    mixedVehicleList.reserve(recordCount);
+    for (std::size_t recordIndex = 0; recordIndex < recordCount; recordIndex++) {
+        const SampleFleet& sourceFleet = recordIndex % 250 == 7 ? edgeCaseFleet : sampleFleet;
+        mixedVehicleList.push_back(sourceFleet.vehicleList[recordIndex % sourceFleet.vehicleList.size()]);
+    }
+    return mixedVehicleList;
+}
+
+// Serializes each vehicle, and whole lists, to a binary format, replays the document
+// into a JSON serializer through BinaryReader and requires the bytes to equal the
+// JSON serializer's direct output, in both the pretty and the compact layout. The
+// lists of 1000 and 70000 records take the 16-bit and 32-bit array headers; the long
+// one leaves out the large edge-case strings to keep the check quick.
+template<class BinaryReader>
+static bool checkReplayMatchesJson(const std::string& binaryFormat, const SampleFleet& sampleFleet, const SampleFleet& edgeCaseFleet) {
+    const std::vector<const Vehicle*> mediumVehicleList = buildMixedVehicleList(sampleFleet, edgeCaseFleet, 1000);
+    const std::vector<const Vehicle*> largeVehicleList = buildMixedVehicleList(sampleFleet, sampleFleet, 70000);
+    const std::pair<std::string, const Vehicle*> namedVehicles[] = {
+        { "car", &edgeCaseFleet.bmwCar },
+        { "airplane", &edgeCaseFleet.boeingPlane },
+        { "ship", &edgeCaseFleet.victoriaShip },
+    };
+    const std::pair<std::string, const std::vector<const Vehicle*>*> namedVehicleLists[] = {
+        { "vehicle list", &edgeCaseFleet.vehicleList },
+        { "1000-vehicle list", &mediumVehicleList },
+        { "70000-vehicle list", &largeVehicleList },
+    };
+
+    std::vector<std::pair<std::string, std::function<void(Serializer&)>>> namedDocuments;
+    for (const auto& [vehicleName, vehicle] : namedVehicles) {
+        namedDocuments.emplace_back(vehicleName, [vehicle](Serializer& serializer) { serializeVehicle(*vehicle, serializer); });
+    }
+    for (const auto& [listName, vehicleList] : namedVehicleLists) {
+        namedDocuments.emplace_back(listName, [vehicleList](Serializer& serializer) { serializeVehicles(*vehicleList, serializer); });
+    }
+
+    bool isPassed = true;
+    for (const auto& [documentName, serializeNamedDocument] : namedDocuments) {
+        auto binarySerializer = createSerializer(binaryFormat);
+        serializeNamedDocument(*binarySerializer);
+        std::string binaryDocument = binarySerializer->build();
+
+        for (bool isPretty : { true, false }) {
+            SerializerOptions jsonOptions;
+            jsonOptions.pretty = isPretty;
+            auto directSerializer = createSerializer("json", jsonOptions);
+            serializeNamedDocument(*directSerializer);
+            std::string directDocument = directSerializer->build();
+
+            auto replayedSerializer = createSerializer("json", jsonOptions);
+            BinaryReader(binaryDocument).replayInto(*replayedSerializer);
+            std::string replayedDocument = replayedSerializer->build();
+
+            if (replayedDocument != directDocument) {
+                reportMismatch(binaryFormat + " replay into " + getLayoutName("json", jsonOptions) + " for " + documentName, directDocument, replayedDocument);
+                isPassed = false;
+            }
+        }
+    }
+    return isPassed;
+}
+
+// Serializing into a warmed-up, reused XML or JSON serializer must not allocate: the
+// addField/addBlock calls for every vehicle kind are counted through operator new.
+static bool checkReusedSerializerAllocations(const SampleFleet& checkedFleet, const std::string& fleetName) {
+    const std::size_t warmupRounds = 4;
+    const std::pair<std::string, const Vehicle*> namedVehicles[] = {
+        { "car", &checkedFleet.bmwCar },
+        { "airplane", &checkedFleet.boeingPlane },
+        { "ship", &checkedFleet.victoriaShip },
+    };
+
+    bool isPassed = true;
+    for (const std::string outputFormat : { "xml", "json" }) {
+        for (bool isPretty : { true, false }) {
+            SerializerOptions serializerOptions;
+            serializerOptions.pretty = isPretty;
+            auto formatSerializer = createSerializer(outputFormat, serializerOptions);
+            for (const auto& [vehicleName, currentVehicle] : namedVehicles) {
+                for (std::size_t warmupRound = 0; warmupRound < warmupRounds; warmupRound++) {
+                    serializeVehicle(*currentVehicle, *formatSerializer);
+                    formatSerializer->reset();
+                }
+
+                std::size_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+                serializeVehicle(*currentVehicle, *formatSerializer);
+                std::size_t allocationsAfter = allocationCount.load(std::memory_order_relaxed);
+                formatSerializer->reset();
+
+                if (allocationsAfter != allocationsBefore) {
+                    std::cerr << "Self-check failed: " << getLayoutName(outputFormat, serializerOptions) << " allocated "
+                        << allocationsAfter - allocationsBefore << " times serializing the " << fleetName << " "
+                        << vehicleName << " into a reused serializer\n";
+                    isPassed = false;
+                }
+            }
+        }
+    }
+    return isPassed;
+}
+
+// Serializes the fleet as a "vehicles" document in outputFormat, reads it back with
+// readVehicles into a local intern table and requires the vehicles it returns to
+// serialize to the same bytes, in both the pretty and the compact layout.
+template<class ReadVehicles>
+static bool checkReaderRoundTrip(const std::string& readerName, const std::string& outputFormat, const SampleFleet& checkedFleet, ReadVehicles readVehicles) {
+    bool isPassed = true;
+    for (bool isPretty : { true, false }) {
+        SerializerOptions serializerOptions;
+        serializerOptions.pretty = isPretty;
+        auto formatSerializer = createSerializer(outputFormat, serializerOptions);
+        serializeVehicles(checkedFleet.vehicleList, *formatSerializer);
+        std::string serializedDocument = formatSerializer->build();
+
+        StringInternTable readInternTable;
+        std::vector<std::unique_ptr<Vehicle>> readVehicleList = readVehicles(serializedDocument, readInternTable);
+        std::vector<const Vehicle*> readVehiclePointers;
+        for (const std::unique_ptr<Vehicle>& readVehicle : readVehicleList) {
+            readVehiclePointers.push_back(readVehicle.get());
+        }
+        formatSerializer->reset();
+        serializeVehicles(readVehiclePointers, *formatSerializer);
+        std::string reserializedDocument = formatSerializer->build();
+
+        if (reserializedDocument != serializedDocument) {
+            reportMismatch(readerName + " round trip of " + getLayoutName(outputFormat, serializerOptions), serializedDocument, reserializedDocument);
+            isPassed = false;
+        }
+    }
+    return isPassed;
+}
+
+// The static serializers promise to write a vehicle exactly as Vehicle::serialize()
+// does through the matching virtual serializer.
+template<class StaticSerializerType, class VehicleType>
+static bool checkStaticVehicleMatches(const std::string& outputFormat, const std::string& vehicleName, const VehicleType& vehicle) {
+    StaticSerializerType staticSerializer;
+    vehicle.serializeTo(staticSerializer.document());
+    std::string staticDocument = staticSerializer.build();
+
+    auto formatSerializer = createSerializer(outputFormat);
+    serializeVehicle(vehicle, *formatSerializer);
+    std::string virtualDocument = formatSerializer->build();
+
+    if (staticDocument != virtualDocument) {
+        reportMismatch(outputFormat + "-static for the " + vehicleName, virtualDocument, staticDocument);
+        return false;
+    }
+    return true;
+}
+
+static bool checkStaticSerializersMatch(const SampleFleet& checkedFleet, const std::string& fleetName) {
+    bool isPassed = true;
+    isPassed = checkStaticVehicleMatches<StaticJsonSerializer>("json", fleetName + " car", checkedFleet.bmwCar) && isPassed;
+    isPassed = checkStaticVehicleMatches<StaticJsonSerializer>("json", fleetName + " airplane", checkedFleet.boeingPlane) && isPassed;
+    isPassed = checkStaticVehicleMatches<StaticJsonSerializer>("json", fleetName + " ship", checkedFleet.victoriaShip) && isPassed;
+    isPassed = checkStaticVehicleMatches<StaticXmlSerializer>("xml", fleetName + " car", checkedFleet.bmwCar) && isPassed;
+    isPassed = checkStaticVehicleMatches<StaticXmlSerializer>("xml", fleetName + " airplane", checkedFleet.boeingPlane) && isPassed;
+    isPassed = checkStaticVehicleMatches<StaticXmlSerializer>("xml", fleetName + " ship", checkedFleet.victoriaShip) && isPassed;
+    return isPassed;
+}
+
+// ParallelBatchSerializer must produce the document serializeVehicles() writes, under
+// either scheduler, whether the document is built in memory or streamed to a sink.
+// The list mixes the edge-case vehicles into many sample ones so that it splits into
+// chunks of unequal cost.
+static bool checkParallelBatchMatches(const SampleFleet& sampleFleet, const SampleFleet& edgeCaseFleet) {
+    const std::size_t recordCount = 1000;
+    const std::size_t threadCount = 4;
+
+    std::vector<const Vehicle*> mixedVehicleList = buildMixedVehicleList(sampleFleet, edgeCaseFleet, recordCount);
+
+    bool isPassed = true;
+    for (const std::string outputFormat : { "xml", "json", "cbor", "msgpack" }) {
+        for (bool isPretty : { true, false }) {
+            SerializerOptions serializerOptions;
+            serializerOptions.pretty = isPretty;
+            auto formatSerializer = createSerializer(outputFormat, serializerOptions);
+            serializeVehicles(mixedVehicleList, *formatSerializer);
+            std::string expectedDocument = formatSerializer->build();
+
+            for (BatchScheduling batchScheduling : { BatchScheduling::StaticChunks, BatchScheduling::WorkStealing }) {
+                std::string checkName = "parallel-batch " + getLayoutName(outputFormat, serializerOptions) + (batchScheduling == BatchScheduling::WorkStealing ? " work-stealing" : " static-chunks");
+
+                ParallelBatchSerializer batchSerializer(outputFormat, threadCount, serializerOptions, batchScheduling);
+                batchSerializer.serializeVehicles(mixedVehicleList);
+                std::string batchDocument = batchSerializer.documentSerializer().build();
+                if (batchDocument != expectedDocument) {
+                    reportMismatch(checkName, expectedDocument, batchDocument);
+                    isPassed = false;
+                }
+
+                std::ostringstream sinkStream;
+                StreamOutputSink streamSink(sinkStream);
+                ParallelBatchSerializer streamingSerializer(outputFormat, threadCount, serializerOptions, batchScheduling);
+                streamingSerializer.documentSerializer().setOutputSink(&streamSink);
+                streamingSerializer.serializeVehicles(mixedVehicleList);
+                streamingSerializer.documentSerializer().finish();
+                if (sinkStream.str() != expectedDocument) {
+                    reportMismatch(checkName + " to a sink", expectedDocument, sinkStream.str());
+                    isPassed = false;
+                }
+            }
+        }
+    }
+    return isPassed;
+}
+
+// A VehicleTable serializes to the same document as serializeVehicles() over the
+// vehicles it was built from, in every format and layout.
+static bool checkVehicleTableMatches(const SampleFleet& checkedFleet, const std::string& fleetName) {
+    VehicleTable vehicleTable;
+    vehicleTable.appendAll(checkedFleet.vehicleList);
+
+    bool isPassed = true;
+    for (const std::string outputFormat : { "xml", "json", "cbor", "msgpack" }) {
+        for (bool isPretty : { true, false }) {
+            SerializerOptions serializerOptions;
+            serializerOptions.pretty = isPretty;
+            auto formatSerializer = createSerializer(outputFormat, serializerOptions);
+            serializeVehicles(checkedFleet.vehicleList, *formatSerializer);
+            std::string expectedDocument = formatSerializer->build();
+
+            formatSerializer->reset();
+            serializeVehicleTable(vehicleTable, *formatSerializer);
+            std::string tableDocument = formatSerializer->build();
+            if (tableDocument != expectedDocument) {
+                reportMismatch("vehicle table " + getLayoutName(outputFormat, serializerOptions) + " for the " + fleetName + " fleet", expectedDocument, tableDocument);
+                isPassed = false;
+            }
+        }
+    }
+    return isPassed;
+}
+
+static int runSelfChecks() {
+    SampleFleet sampleFleet;
+    fillSampleFleet(sampleFleet, 3);
+    SampleFleet edgeCaseFleet;
+    fillEdgeCaseFleet(edgeCaseFleet);
+
+    bool isPassed = true;
+    try {
+        isPassed = checkReplayMatchesJson<CborReader>("cbor", sampleFleet, edgeCaseFleet) && isPassed;
+        isPassed = checkReplayMatchesJson<MsgPackReader>("msgpack", sampleFleet, edgeCaseFleet) && isPassed;
+        isPassed = checkReusedSerializerAllocations(sampleFleet, "sample") && isPassed;
+        isPassed = checkReusedSerializerAllocations(edgeCaseFleet, "edge-case") && isPassed;
+        isPassed = checkReaderRoundTrip("JsonDeserializer", "json", edgeCaseFleet, [](const std::string& serializedDocument, StringInternTable& internTable) {
+            JsonDeserializer jsonDeserializer(serializedDocument);
+            std::vector<std::unique_ptr<Vehicle>> vehicleList = deserializeVehicles(jsonDeserializer, internTable);
+            jsonDeserializer.finish();
+            return vehicleList;
+        }) && isPassed;
+        for (SimdLevel simdLevel : { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 }) {
+            std::string readerName = "IndexedJsonDeserializer/" + getSimdLevelName(limitSimdLevel(simdLevel));
+            isPassed = checkReaderRoundTrip(readerName, "json", edgeCaseFleet, [simdLevel](const std::string& serializedDocument, StringInternTable& internTable) {
+                IndexedJsonDeserializer jsonDeserializer(serializedDocument, simdLevel);
+                std::vector<std::unique_ptr<Vehicle>> vehicleList = deserializeVehicles(jsonDeserializer, internTable);
+                jsonDeserializer.finish();
+                return vehicleList;
+            }) && isPassed;
+        }
+        // XmlDeserializer decodes in place, so it reads a copy of the document.
+        isPassed = checkReaderRoundTrip("XmlDeserializer", "xml", edgeCaseFleet, [](std::string serializedDocument, StringInternTable& internTable) {
+            XmlDeserializer xmlDeserializer(serializedDocument);
+            std::vector<std::unique_ptr<Vehicle>> vehicleList = deserializeVehicles(xmlDeserializer, internTable);
+            xmlDeserializer.finish();
+            return vehicleList;
+        }) && isPassed;
+        isPassed = checkStaticSerializersMatch(sampleFleet, "sample") && isPassed;
+        isPassed = checkStaticSerializersMatch(edgeCaseFleet, "edge-case") && isPassed;
+        isPassed = checkParallelBatchMatches(sampleFleet, edgeCaseFleet) && isPassed;
+        isPassed = checkVehicleTableMatches(sampleFleet, "sample") && isPassed;
+        isPassed = checkVehicleTableMatches(edgeCaseFleet, "edge-case") && isPassed;
+    }
+    catch (const std::exception& exception) {
+        std::cerr << "Self-check failed with an exception: " << exception.what() << "\n";
+        isPassed = false;
+    }
+    if (!isPassed) {
+        return 1;
+    }
+    std::cout << "All self-checks passed\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    bool isJsonOutput = false;
+    bool isFleetMatrixOnly = false;
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++) {
+        std::string_view argument = argv[argumentIndex];
+        if (argument == "--json") {
+            isJsonOutput = true;
+        }
+        else if (argument == "--fleet-matrix") {
+            isFleetMatrixOnly = true;
+        }
+        else if (argument == "--self-check") {
+            return runSelfChecks();
+        }
+        else {
+            std::cerr << "Usage: PracticeCpp222Benchmarks [--json] [--fleet-matrix] [--self-check]\n"
+                << "  --json          print the results as JSON instead of a table\n"
+                << "  --fleet-matrix  run only the xml/json fleet matrix\n"
+                << "  --self-check    verify format round trips instead of timing, exit 1 on failure\n";
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> benchmarkResults;
+    runFleetMatrix(benchmarkResults);
+    if (isFleetMatrixOnly) {
+        printResults(benchmarkResults, isJsonOutput);
+        return 0;
+    }
+
+    const std::size_t recordCount = 100000;
+
+    SampleFleet sampleFleet;
+    fillSampleFleet(sampleFleet, recordCount);
+
+    for (const std::string outputFormat : { "xml", "json" }) {
+        benchmarkResults.push_back(benchmarkFreshSerializerPerRecord(outputFormat, sampleFleet));
+        benchmarkResults.push_back(benchmarkReusedSerializer(outputFormat, sampleFleet));
+        benchmarkResults.push_back(benchmarkStreamingToMemorySpan(outputFormat, sampleFleet));
+        benchmarkResults.push_back(benchmarkVehicleListDocument(outputFormat + "/batch-document", outputFormat, sampleFleet.vehicleList));
+    }
+    SerializerOptions metricsOptions;
+    metricsOptions.collectMetrics = true;
+    for (const std::string outputFormat : { "xml", "json" }) {
+        benchmarkResults.push_back(benchmarkVehicleListDocument(getLayoutName(outputFormat, metricsOptions) + "/batch-document", outputFormat, sampleFleet.vehicleList, metricsOptions));
+    }
+
+    const std::size_t maxThreadCount = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    for (const std::string outputFormat : { "xml", "json" }) {
+        for (std::size_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+            benchmarkResults.push_back(benchmarkParallelBatchDocument("parallel-batch", outputFormat, threadCount, BatchScheduling::StaticChunks, sampleFleet));
+        }
+    }
+
+    SampleFleet skewedFleet;
+    fillSkewedFleet(skewedFleet, sampleFleet, recordCount);
+    for (const std::string outputFormat : { "xml", "json" }) {
+        for (std::size_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+            benchmarkResults.push_back(benchmarkParallelBatchDocument("skewed-batch", outputFormat, threadCount, BatchScheduling::StaticChunks, skewedFleet));
+            benchmarkResults.push_back(benchmarkParallelBatchDocument("skewed-batch", outputFormat, threadCount, BatchScheduling::WorkStealing, skewedFleet));
+        }
+    }
+
+    for (const std::string outputFormat : { "json", "msgpack", "cbor" }) {
+        benchmarkEachVehicleKind(benchmarkResults, outputFormat, sampleFleet, recordCount);
+    }
+
+    for (const std::string outputFormat : { "xml" }) {
+        benchmarkEachVehicleKind(benchmarkResults, outputFormat, sampleFleet, recordCount);
+    }
+    SerializerOptions compactOptions;
+    compactOptions.pretty = false;
+    for (const std::string outputFormat : { "xml", "json" }) {
+        benchmarkEachVehicleKind(benchmarkResults, outputFormat, sampleFleet, recordCount, compactOptions);
+        benchmarkResults.push_back(benchmarkVehicleListDocument(getLayoutName(outputFormat, compactOptions) + "/batch-document", outputFormat, sampleFleet.vehicleList, compactOptions));
+    }
+
+    benchmarkResults.push_back(benchmarkJsonDeserializeBatch(sampleFleet));
+    benchmarkResults.push_back(benchmarkJsonDeserializeBatch(sampleFleet, compactOptions));
+    benchmarkResults.push_back(benchmarkXmlDeserializeBatch(sampleFleet));
+    benchmarkResults.push_back(benchmarkXmlDeserializeBatch(sampleFleet, compactOptions));
+    HeapFleet heapFleet;
+    fillHeapFleet(heapFleet, sampleFleet);
+    VehicleTable vehicleTable;
+    vehicleTable.appendAll(heapFleet.vehicleList);
+    for (const std::string outputFormat : { "xml", "json" }) {
+        benchmarkResults.push_back(benchmarkVehicleListDocument(outputFormat + "/heap-objects-document", outputFormat, heapFleet.vehicleList));
+        benchmarkResults.push_back(benchmarkDocuments(outputFormat + "/vehicle-table-document", outputFormat, {}, vehicleTable.size(), 1, [&](Serializer& formatSerializer) {
+            serializeVehicleTable(vehicleTable, formatSerializer);
+        }));
+    }
+    std::vector<const Vehicle*> shuffledVehicleList = heapFleet.vehicleList;
+    std::shuffle(shuffledVehicleList.begin(), shuffledVehicleList.end(), std::mt19937(42));
+    VehicleCollection vehicleCollection;
+    for (const Vehicle* vehicle : shuffledVehicleList) {
+        if (const Car* car = dynamic_cast<const Car*>(vehicle)) {
+            vehicleCollection.insert(*car);
+        }
+        else if (const Airplane* airplane = dynamic_cast<const Airplane*>(vehicle)) {
+            vehicleCollection.insert(*airplane);
+        }
+        else {
+            vehicleCollection.insert(static_cast<const Ship&>(*vehicle));
+        }
+    }
+    for (const std::string outputFormat : { "xml", "json" }) {
+        benchmarkResults.push_back(benchmarkVehicleListDocument(outputFormat + "/shuffled-pointers-document", outputFormat, shuffledVehicleList));
+        benchmarkResults.push_back(benchmarkDocuments(outputFormat + "/vehicle-collection-document", outputFormat, {}, vehicleCollection.size(), 1, [&](Serializer& formatSerializer) {
+            serializeVehicleCollection(vehicleCollection, formatSerializer);
+        }));
+    }
+    benchmarkResults.push_back(benchmarkVehicleCollectionCopy(vehicleCollection));
+    BatchArena batchArena;
+    for (const std::string outputFormat : { "xml", "json" }) {
+        benchmarkResults.push_back(benchmarkIngestBatch(outputFormat, sampleFleet, nullptr));
+        benchmarkResults.push_back(benchmarkIngestBatch(outputFormat, sampleFleet, &batchArena));
+        benchmarkResults.push_back(benchmarkExportBatch(outputFormat, vehicleCollection, nullptr));
+        benchmarkResults.push_back(benchmarkExportBatch(outputFormat, vehicleCollection, &batchArena));
+    }
+    benchmarkResults.push_back(benchmarkHeapFleetWeightScan(heapFleet));
+    benchmarkResults.push_back(benchmarkVehicleTableWeightScan(vehicleTable));
+
+    for (const std::string outputFormat : { "xml", "json" }) {
+        benchmarkResults.push_back(benchmarkExportThroughStream(outputFormat, sampleFleet));
+        benchmarkResults.push_back(benchmarkExportThroughMapping(outputFormat, sampleFleet));
+    }
+    benchmarkResults.push_back(benchmarkXmlImportThroughStream(sampleFleet));
+    benchmarkResults.push_back(benchmarkXmlImportThroughMapping(sampleFleet));
+    for (const std::string outputFormat : { "xml", "json" }) {
+        std::filesystem::remove(getExportPath(outputFormat));
+    }
+
+    std::vector<std::string> sampleVehicleNames = makeSampleVehicleNames(recordCount);
+    for (const std::string outputFormat : { "xml", "json" }) {
+        benchmarkResults.push_back(benchmarkEscapedBatchDocument(outputFormat, sampleFleet, makeEscapingOptions(false, SimdLevel::Avx2)));
+        benchmarkResults.push_back(benchmarkEscapeNames(outputFormat, sampleVehicleNames, makeEscapingOptions(false, SimdLevel::Avx2)));
+    }
+    for (SimdLevel simdLevel : { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 }) {
+        if (limitSimdLevel(simdLevel) != simdLevel) {
+            continue;
+        }
+        for (const std::string outputFormat : { "xml", "json" }) {
+            benchmarkResults.push_back(benchmarkEscapedBatchDocument(outputFormat, sampleFleet, makeEscapingOptions(true, simdLevel)));
+            benchmarkResults.push_back(benchmarkEscapeNames(outputFormat, sampleVehicleNames, makeEscapingOptions(true, simdLevel)));
+        }
+        benchmarkResults.push_back(benchmarkJsonStructuralIndex(sampleFleet, simdLevel));
+        benchmarkResults.push_back(benchmarkJsonStructuralIndex(sampleFleet, simdLevel, compactOptions));
+        benchmarkResults.push_back(benchmarkIndexedJsonDeserializeBatch(sampleFleet, simdLevel));
+        benchmarkResults.push_back(benchmarkIndexedJsonDeserializeBatch(sampleFleet, simdLevel, compactOptions));
+    }
+
+    benchmarkResults.push_back(benchmarkStaticVehicleKind<StaticJsonSerializer>("json-static/car", sampleFleet.bmwCar, recordCount));
+    benchmarkResults.push_back(benchmarkStaticVehicleKind<StaticJsonSerializer>("json-static/airplane", sampleFleet.boeingPlane, recordCount));
+    benchmarkResults.push_back(benchmarkStaticVehicleKind<StaticJsonSerializer>("json-static/ship", sampleFleet.victoriaShip, recordCount));
+    benchmarkResults.push_back(benchmarkStaticVehicleKind<StaticXmlSerializer>("xml-static/car", sampleFleet.bmwCar, recordCount));
+    benchmarkResults.push_back(benchmarkStaticVehicleKind<StaticXmlSerializer>("xml-static/airplane", sampleFleet.boeingPlane, recordCount));
+    benchmarkResults.push_back(benchmarkStaticVehicleKind<StaticXmlSerializer>("xml-static/ship", sampleFleet.victoriaShip, recordCount));
+
+    std::vector<double> sampleDoubles = makeSampleDoubles(recordCount);
+    benchmarkResults.push_back(benchmarkToStringDoubles(sampleDoubles));
+    benchmarkResults.push_back(benchmarkFormatDoubles("shortest", { DoubleFormatMode::Shortest, 6 }, sampleDoubles));
+    benchmarkResults.push_back(benchmarkFormatDoubles("fixed6", { DoubleFormatMode::FixedPrecision, 6 }, sampleDoubles));
+    benchmarkResults.push_back(benchmarkFormatDoubles("integral", { DoubleFormatMode::IntegralWithoutFraction, 6 }, sampleDoubles));
+
+    std::vector<int> sampleIntegers = makeSampleIntegers(recordCount);
+    benchmarkResults.push_back(benchmarkToStringIntegers(sampleIntegers));
+    benchmarkResults.push_back(benchmarkFormatIntegers(sampleIntegers));
+
+    printResults(benchmarkResults, isJsonOutput);
+    return 0;
+}